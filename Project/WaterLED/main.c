@@ -22,23 +22,139 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "app_uart.h"
 #include "app_error.h"
-#include "nrf_delay.h"
 #include "nrf_gpio.h"
 #include "nrf.h"
+#include "nordic_common.h"
 #include "boards.h"
 #include "SEGGER_RTT.h"
+#include "app_shell.h"
+#include "app_stdout.h"
+#include "app_scheduler.h"
+#include "app_timer.h"
+#include "app_pm.h"
+#include "app_pt.h"
+#include "app_led.h"
+#include "app_button.h"
+#include "app_stack.h"
+#include "app_pool.h"
+#include "app_fifo.h"
+#include "app_timestamp.h"
+#ifdef APP_IRQ_PROFILE
+#include "app_irq_prof.h"
+#endif
+#ifdef CRASH_LOG_ENABLED
+#include "crash_log.h"
+#endif
+#ifdef APP_FAULT_ENABLED
+#include "app_fault.h"
+#endif
 
 const uint8_t leds_list[LEDS_NUMBER] = LEDS_LIST;
+const uint8_t buttons_list[BUTTONS_NUMBER] = BUTTONS_LIST;
 
 #define MAX_TEST_DATA_BYTES     (15U)                /**< max number of test bytes to be used for tx and rx. */
 #define UART_TX_BUF_SIZE 256                         /**< UART TX buffer size. */
 #define UART_RX_BUF_SIZE 1                           /**< UART RX buffer size. */
+#define SHELL_POLL_MIN_MS       20                   /**< Interval at which RTT input is checked while it arrives. */
+#define SHELL_POLL_MAX_MS       1000                 /**< Interval reached by doubling while no input arrives. */
+#define SHELL_SYSOFF_IDLE_MS    300000               /**< Time without input after which polling stops and System OFF is entered, 0 for never. */
+#define SCHED_MAX_EVENT_DATA_SIZE MAX(MAX(sizeof(app_uart_evt_t), sizeof(app_button_evt_t)), sizeof(uart_frame_t)) /**< Largest event put into the scheduler queue. */
+#define SCHED_QUEUE_SIZE        16                   /**< Number of events the scheduler queue can hold. */
+#define BLINK_PERIOD_MS         500                  /**< Blink period of the led blink command. */
+#define BLINK_ON_MS             100                  /**< On time of LED 0 in each blink. */
+#define BREATHE_STEP_MS         60                   /**< Time each brightness step of the breathe pattern lasts. */
+#define BREATHE_PWM_TICKS       APP_LED_TICKS(10)    /**< PWM period of the breathe pattern. */
+#define CHASE_STEP_MS           150                  /**< Time each LED is lit in the chase pattern. */
+#define BENCH_PAIRS             10000                /**< Pairs of calls timed by the bench command. */
+#define BENCH_FIFO_SIZE         4                    /**< Size of the FIFO timed by the bench command. */
+#define FAULT_STACK_PER_LINE    8                    /**< Stack words per line of a printed fault dump. */
+#define UART_FRAME_SIZE         APP_POOL1_BLOCK_SIZE /**< Longest UART line kept, terminator included. */
+
+#ifndef BUILD_PROFILE
+#define BUILD_PROFILE           speed                /**< Optimisation profile, PROFILE in the Makefile. */
+#endif
+#define STRINGIFY_(X)           #X
+#define STRINGIFY(X)            STRINGIFY_(X)        /**< Expands X into a string. */
+
+/**@brief UART line passed from the UART event handler to the scheduler. */
+typedef struct
+{
+    char *   p_data;                                 /**< Pool block holding the line, zero-terminated. */
+    uint16_t length;                                 /**< Length of the line. */
+} uart_frame_t;
+
+static char *   m_p_uart_frame;                      /**< Line being received, NULL before its first byte. */
+static uint16_t m_uart_frame_len;                    /**< Bytes in m_p_uart_frame. */
+static uint32_t m_uart_frame_dropped;                /**< Bytes dropped for want of a pool block or room. */
+
+/**@brief Function for printing a received UART line and freeing its block. */
+static void uart_frame_evt_handler(void * p_event_data, uint16_t event_size)
+{
+    uart_frame_t const * p_frame = (uart_frame_t const *)p_event_data;
+
+    UNUSED_PARAMETER(event_size);
+
+    printf("\n\ruart: %s (%u bytes)\n\r", p_frame->p_data, p_frame->length);
+    APP_ERROR_CHECK(app_pool_free(p_frame->p_data));
+}
+
+
+/**@brief Function for collecting UART bytes into lines, each in a pool block.
+ *
+ * @details A line ends with CR or LF; empty lines are skipped. The block is handed over with the
+ *          scheduler event and freed by uart_frame_evt_handler(), so a new line can be received
+ *          while the previous one waits in the queue.
+ */
+static void uart_frame_receive(void)
+{
+    uart_frame_t frame;
+    uint8_t      byte;
+
+    while (app_uart_get(&byte) == NRF_SUCCESS)
+    {
+        if ((byte != '\r') && (byte != '\n'))
+        {
+            if (m_p_uart_frame == NULL)
+            {
+                m_p_uart_frame   = app_pool_alloc(UART_FRAME_SIZE);
+                m_uart_frame_len = 0;
+            }
+            if ((m_p_uart_frame != NULL) && (m_uart_frame_len < UART_FRAME_SIZE - 1))
+            {
+                m_p_uart_frame[m_uart_frame_len++] = (char)byte;
+            }
+            else
+            {
+                m_uart_frame_dropped++;
+            }
+        }
+        else if (m_p_uart_frame != NULL)
+        {
+            m_p_uart_frame[m_uart_frame_len] = '\0';
+            frame.p_data   = m_p_uart_frame;
+            frame.length   = m_uart_frame_len;
+            m_p_uart_frame = NULL;
+            if (app_sched_event_put(&frame, sizeof(frame), uart_frame_evt_handler) != NRF_SUCCESS)
+            {
+                m_uart_frame_dropped += frame.length;
+                APP_ERROR_CHECK(app_pool_free(frame.p_data));
+            }
+        }
+    }
+}
+
 
 void uart_error_handle(app_uart_evt_t * p_event)
 {
-    if (p_event->evt_type == APP_UART_COMMUNICATION_ERROR)
+    if (p_event->evt_type == APP_UART_DATA_READY)
+    {
+        uart_frame_receive();
+    }
+    else if (p_event->evt_type == APP_UART_COMMUNICATION_ERROR)
     {
         APP_ERROR_HANDLER(p_event->data.error_communication);
     }
@@ -48,16 +164,749 @@ void uart_error_handle(app_uart_evt_t * p_event)
     }
 }
 
+#ifdef CRASH_LOG_ENABLED
+/**@brief Function for replaying the log preserved across the last reset over RTT.
+ */
+static void crash_log_replay(char const * p_data, uint32_t length)
+{
+    static bool started = false;
+
+    if (!started)
+    {
+        SEGGER_RTT_WriteString(0, "\n\r--- log before reset ---\n\r");
+        started = true;
+    }
+    SEGGER_RTT_Write(0, p_data, length);
+}
+#endif
+
+/**@brief Blink of LED 0; the duration is set by the led blink command. */
+static app_led_segment_t m_blink_segment =
+{
+    0, APP_LED_TICKS(BLINK_PERIOD_MS), {APP_LED_TICKS(BLINK_ON_MS), APP_LED_OFF, APP_LED_OFF}
+};
+
+static const app_led_pattern_t m_blink_pattern = {&m_blink_segment, 1};
+
+/**@brief Breathe step: all LEDs on for LEVEL eighths of the PWM period. */
+#define BREATHE_STEP(LEVEL)                                                         \
+    {                                                                               \
+        BREATHE_STEP_MS, BREATHE_PWM_TICKS,                                         \
+        {                                                                           \
+            (BREATHE_PWM_TICKS * (LEVEL)) / 8,                                      \
+            (BREATHE_PWM_TICKS * (LEVEL)) / 8,                                      \
+            (BREATHE_PWM_TICKS * (LEVEL)) / 8                                       \
+        }                                                                           \
+    }
+
+static const app_led_segment_t m_breathe_segments[] =
+{
+    BREATHE_STEP(0), BREATHE_STEP(1), BREATHE_STEP(2), BREATHE_STEP(3),
+    BREATHE_STEP(4), BREATHE_STEP(5), BREATHE_STEP(6), BREATHE_STEP(7),
+    BREATHE_STEP(8), BREATHE_STEP(7), BREATHE_STEP(6), BREATHE_STEP(5),
+    BREATHE_STEP(4), BREATHE_STEP(3), BREATHE_STEP(2), BREATHE_STEP(1),
+};
+
+static const app_led_pattern_t m_breathe_pattern =
+{
+    m_breathe_segments, sizeof(m_breathe_segments) / sizeof(m_breathe_segments[0])
+};
+
+static const app_led_segment_t m_chase_segments[] =
+{
+    {CHASE_STEP_MS, 0, {APP_LED_ON,  APP_LED_OFF, APP_LED_OFF}},
+    {CHASE_STEP_MS, 0, {APP_LED_OFF, APP_LED_ON,  APP_LED_OFF}},
+    {CHASE_STEP_MS, 0, {APP_LED_OFF, APP_LED_OFF, APP_LED_ON }},
+};
+
+static const app_led_pattern_t m_chase_pattern =
+{
+    m_chase_segments, sizeof(m_chase_segments) / sizeof(m_chase_segments[0])
+};
+
+
+/**@brief Function for handling the led command.
+ *
+ * @details led on|off|next|toggle <n>|blink <n>|breathe|chase|level <l0> <l1> <l2>|
+ *          fade <l0> <l1> <l2> <ms>
+ */
+static void led_cmd(uint32_t argc, char ** argv)
+{
+    static uint32_t next = 0;
+    uint32_t        err_code;
+    uint8_t         levels[APP_LED_COUNT];
+    uint32_t        i;
+
+    if ((argc == 3) && (strcmp(argv[1], "blink") == 0))
+    {
+        m_blink_segment.duration_ms = (uint16_t)MIN((uint32_t)atoi(argv[2]) * BLINK_PERIOD_MS,
+                                                    UINT16_MAX);
+        if (m_blink_segment.duration_ms == 0)
+        {
+            app_led_stop();
+            return;
+        }
+        err_code = app_led_play(&m_blink_pattern, 1);
+        APP_ERROR_CHECK(err_code);
+        return;
+    }
+    if ((argc == 2) && (strcmp(argv[1], "breathe") == 0))
+    {
+        err_code = app_led_play(&m_breathe_pattern, 0);
+        APP_ERROR_CHECK(err_code);
+        return;
+    }
+    if ((argc == 2) && (strcmp(argv[1], "chase") == 0))
+    {
+        err_code = app_led_play(&m_chase_pattern, 0);
+        APP_ERROR_CHECK(err_code);
+        return;
+    }
+    if (((argc == 2 + APP_LED_COUNT) && (strcmp(argv[1], "level") == 0)) ||
+        ((argc == 3 + APP_LED_COUNT) && (strcmp(argv[1], "fade") == 0)))
+    {
+        for (i = 0; i < APP_LED_COUNT; i++)
+        {
+            levels[i] = (uint8_t)MIN((uint32_t)atoi(argv[2 + i]), UINT8_MAX);
+        }
+        app_led_fade(levels, (argc == 3 + APP_LED_COUNT) ?
+                             (uint16_t)MIN((uint32_t)atoi(argv[2 + APP_LED_COUNT]), UINT16_MAX) : 0);
+        return;
+    }
+
+    // The remaining commands drive the pins directly.
+    app_led_stop();
+    if ((argc == 2) && (strcmp(argv[1], "on") == 0))
+    {
+        LEDS_ON(LEDS_MASK);
+        next = 0;
+    }
+    else if ((argc == 2) && (strcmp(argv[1], "off") == 0))
+    {
+        LEDS_OFF(LEDS_MASK);
+        next = 0;
+    }
+    else if ((argc == 2) && (strcmp(argv[1], "next") == 0))
+    {
+        LEDS_INVERT(1 << leds_list[next]);
+        next = (next + 1) % LEDS_NUMBER;
+    }
+    else if ((argc == 3) && (strcmp(argv[1], "toggle") == 0)
+             && ((uint32_t)atoi(argv[2]) < LEDS_NUMBER))
+    {
+        LEDS_INVERT(1 << leds_list[atoi(argv[2])]);
+    }
+    else
+    {
+        SEGGER_RTT_printf(0, "\n\rusage: led on|off|next|toggle <0..%u>|blink <n>|breathe|chase|"
+                          "level <l0> <l1> <l2>|fade <l0> <l1> <l2> <ms>", LEDS_NUMBER - 1);
+    }
+}
+
+
+/**@brief Function for handling button events.
+ *
+ * @details A short press toggles the LED with the number of the button, a double press plays
+ *          the chase pattern, a long press the breathe pattern, and a chord stops the LEDs.
+ */
+static void button_evt_handler(app_button_evt_t const * p_evt)
+{
+    static const char * const evt_names[] = {"short", "long", "double", "chord"};
+    uint32_t                  err_code;
+    uint8_t                   button = 0;
+
+    printf("\n\rbutton %s 0x%02x", evt_names[p_evt->type], p_evt->buttons);
+
+    switch (p_evt->type)
+    {
+        case APP_BUTTON_EVT_SHORT:
+            while ((p_evt->buttons & (1 << button)) == 0)
+            {
+                button++;
+            }
+            app_led_stop();
+            LEDS_INVERT(1 << leds_list[button % LEDS_NUMBER]);
+            break;
+
+        case APP_BUTTON_EVT_DOUBLE:
+            err_code = app_led_play(&m_chase_pattern, 0);
+            APP_ERROR_CHECK(err_code);
+            break;
+
+        case APP_BUTTON_EVT_LONG:
+            err_code = app_led_play(&m_breathe_pattern, 0);
+            APP_ERROR_CHECK(err_code);
+            break;
+
+        default:
+            app_led_stop();
+            break;
+    }
+}
+
+
+/**@brief Function for handling the reset command.
+ */
+static void reset_cmd(uint32_t argc, char ** argv)
+{
+    UNUSED_PARAMETER(argc);
+    UNUSED_PARAMETER(argv);
+
+    NVIC_SystemReset();
+}
+
+
+/**@brief Function for handling the stdout command.
+ *
+ * @details stdout [rtt|uart|both|none]
+ */
+static void stdout_cmd(uint32_t argc, char ** argv)
+{
+    // Indexed by APP_STDOUT_SINK_* value.
+    static const char * const sink_names[] = {"none", "rtt", "uart", "both"};
+    uint8_t                   sinks;
+
+    if (argc == 2)
+    {
+        for (sinks = 0; sinks < sizeof(sink_names) / sizeof(sink_names[0]); sinks++)
+        {
+            if (strcmp(argv[1], sink_names[sinks]) == 0)
+            {
+                break;
+            }
+        }
+        if (app_stdout_sinks_set(sinks) != NRF_SUCCESS)
+        {
+            SEGGER_RTT_WriteString(0, "\n\rusage: stdout [rtt|uart|both|none]");
+            return;
+        }
+    }
+
+    SEGGER_RTT_printf(0, "\n\rstdout: %s (dropped rtt %u, uart %u)",
+                      sink_names[app_stdout_sinks_get()],
+                      app_stdout_dropped_get(APP_STDOUT_SINK_RTT),
+                      app_stdout_dropped_get(APP_STDOUT_SINK_UART));
+}
+
+
+/**@brief Function for handling the pm command.
+ *
+ * @details pm [reset]
+ */
+static void pm_cmd(uint32_t argc, char ** argv)
+{
+    // Indexed by app_pm_state_t.
+    static const char * const state_names[] = {"active", "idle+hfclk", "idle"};
+    app_pm_stats_t            stats;
+    uint32_t                  total = 0;
+    uint32_t                  i;
+
+    if ((argc == 2) && (strcmp(argv[1], "reset") == 0))
+    {
+        app_pm_stats_reset();
+        return;
+    }
+
+    app_pm_stats_get(&stats);
+    for (i = 0; i < APP_PM_STATE_COUNT; i++)
+    {
+        total += stats.ticks[i];
+    }
+    for (i = 0; i < APP_PM_STATE_COUNT; i++)
+    {
+        SEGGER_RTT_printf(0, "\n\r%s: %u ms, %u/1000, entered %u times", state_names[i],
+                          APP_TIMER_MS(stats.ticks[i]),
+                          (total != 0) ? (uint32_t)(((uint64_t)stats.ticks[i] * 1000) / total) : 0,
+                          stats.entries[i]);
+    }
+#ifdef APP_UART_ISR_PROFILE
+    SEGGER_RTT_printf(0, "\n\ruart isr max %u us", app_uart_isr_time_max_get());
+#endif
+#ifdef APP_UART_WITH_SCHEDULER
+    SEGGER_RTT_printf(0, "\n\ruart events dropped %u", app_uart_evt_dropped_get());
+#endif
+}
+
+
+/**@brief Function for handling the sched command.
+ *
+ * @details sched [reset]
+ */
+static void sched_cmd(uint32_t argc, char ** argv)
+{
+    // Indexed by app_sched_prio_t.
+    static const char * const prio_names[] = {"high", "normal", "low", "background"};
+    app_sched_stats_t         stats;
+    uint32_t                  i;
+#ifdef APP_SCHED_PROFILE
+    uint32_t                  j;
+#endif
+
+    if ((argc == 2) && (strcmp(argv[1], "reset") == 0))
+    {
+        app_sched_stats_reset();
+        return;
+    }
+
+    app_sched_stats_get(&stats);
+    SEGGER_RTT_printf(0, "\n\rqueue max %u/%u, aged %u", stats.depth_max, stats.queue_size, stats.aged);
+    for (i = 0; i < APP_SCHED_PRIO_COUNT; i++)
+    {
+        SEGGER_RTT_printf(0, "\n\r%s: run %u, dropped %u", prio_names[i],
+                          stats.executed[i], stats.dropped[i]);
+#ifdef APP_SCHED_PROFILE
+        // Bucket j counts waits of 2^(j-1) to 2^j - 1 ticks of about 30.5 us.
+        SEGGER_RTT_WriteString(0, ", wait");
+        for (j = 0; j < APP_SCHED_LATENCY_BUCKETS; j++)
+        {
+            SEGGER_RTT_printf(0, " %u", stats.latency[i][j]);
+        }
+#endif
+    }
+}
+
+
+/**@brief Function for handling the delay command.
+ *
+ * @details delay <us>: runs app_timer_delay_us() and prints the time it took, counted by RTC1
+ *          to within a tick (about 31 us), and by TIMER2 to the microsecond in profiling builds.
+ */
+static void delay_cmd(uint32_t argc, char ** argv)
+{
+    uint32_t us;
+    uint32_t start;
+    uint32_t end;
+    uint32_t ticks;
+#ifdef APP_UART_ISR_PROFILE
+    uint16_t timestamp;
+    uint16_t elapsed;
+#endif
+
+    if (argc != 2)
+    {
+        SEGGER_RTT_WriteString(0, "\n\rusage: delay <us>");
+        return;
+    }
+    us = (uint32_t)strtoul(argv[1], NULL, 10);
+
+    (void)app_timer_cnt_get(&start);
+#ifdef APP_UART_ISR_PROFILE
+    timestamp = app_timestamp_get();
+#endif
+    app_timer_delay_us(us);
+#ifdef APP_UART_ISR_PROFILE
+    elapsed = app_timestamp_elapsed(timestamp);
+#endif
+    (void)app_timer_cnt_get(&end);
+    (void)app_timer_cnt_diff_compute(end, start, &ticks);
+
+    SEGGER_RTT_printf(0, "\n\rdelay %u us: rtc %u ticks (%u us)", us, ticks,
+                      (uint32_t)(((uint64_t)ticks * 1000000) / APP_TIMER_CLOCK_FREQ));
+#ifdef APP_UART_ISR_PROFILE
+    SEGGER_RTT_printf(0, ", timer2 %u us mod 65536", elapsed);
+#endif
+}
+
+
+/**@brief Runs BODY BENCH_PAIRS times and stores the RTC1 ticks taken in TICKS. */
+#define BENCH_LOOP(TICKS, BODY)                                                     \
+    do                                                                              \
+    {                                                                               \
+        uint32_t start;                                                             \
+        uint32_t end;                                                               \
+        for (i = 0, (void)app_timer_cnt_get(&start); i < BENCH_PAIRS; i++)          \
+        {                                                                           \
+            BODY;                                                                   \
+        }                                                                           \
+        (void)app_timer_cnt_get(&end);                                              \
+        (void)app_timer_cnt_diff_compute(end, start, &(TICKS));                     \
+    } while (0)
+
+
+/**@brief Function for printing the CPU cycles per pair of a benchmark, in hundredths.
+ */
+static void bench_print(char const * p_name, uint32_t ticks, uint32_t base_ticks)
+{
+    // 16 MHz / 32768 Hz = 15625 / 32 cycles per tick.
+    uint32_t centicycles = (uint32_t)(((uint64_t)(ticks - MIN(ticks, base_ticks)) * 15625 * 100) /
+                                      (32ULL * BENCH_PAIRS));
+
+    SEGGER_RTT_printf(0, "\n\r%s: %u.%02u cycles", p_name, centicycles / 100, centicycles % 100);
+}
+
+
+/**@brief Function for handling the bench command.
+ *
+ * @details Times BENCH_PAIRS enter/exit pairs of each kind of critical region, put/get pairs on
+ *          a FIFO as the UART interrupt does, and alloc/free pairs on the block pool, against
+ *          RTC1. Prints the CPU cycles per pair, less the cost of the loop itself, after the
+ *          build profile, so that builds can be compared. Interrupts taken meanwhile are
+ *          counted in.
+ */
+static void bench_cmd(uint32_t argc, char ** argv)
+{
+    volatile uint32_t i;
+    uint32_t          base_ticks;
+    uint32_t          ticks;
+    uint8_t           nested;
+    app_fifo_t        fifo;
+    uint8_t           fifo_buf[BENCH_FIFO_SIZE];
+    uint8_t           byte;
+    void *            p_block;
+
+    UNUSED_PARAMETER(argc);
+    UNUSED_PARAMETER(argv);
+
+    SEGGER_RTT_WriteString(0, "\n\rprofile: " STRINGIFY(BUILD_PROFILE));
+    BENCH_LOOP(base_ticks, __NOP());
+    BENCH_LOOP(ticks, __disable_irq(); __enable_irq());
+    bench_print("primask", ticks, base_ticks);
+#ifdef SOFTDEVICE_PRESENT
+    BENCH_LOOP(ticks, nested = app_critical_region_enter(); app_critical_region_exit(nested));
+    bench_print("inline", ticks, base_ticks);
+    // Without the SoftDevice enabled, this is the SVC round trip which returns an error.
+    BENCH_LOOP(ticks, (void)sd_nvic_critical_region_enter(&nested);
+                      (void)sd_nvic_critical_region_exit(nested));
+    bench_print("svc", ticks, base_ticks);
+#else
+    UNUSED_VARIABLE(nested);
+    BENCH_LOOP(ticks, critical_region_enter(); critical_region_exit());
+    bench_print("critical_region", ticks, base_ticks);
+#endif
+
+    (void)app_fifo_init(&fifo, fifo_buf, sizeof(fifo_buf));
+    BENCH_LOOP(ticks, (void)app_fifo_put(&fifo, 0x55); (void)app_fifo_get(&fifo, &byte));
+    bench_print("fifo", ticks, base_ticks);
+
+    BENCH_LOOP(ticks, p_block = app_pool_alloc(APP_POOL0_BLOCK_SIZE); (void)app_pool_free(p_block));
+    bench_print("pool", ticks, base_ticks);
+}
+
+#ifdef APP_CRIT_PROFILE
+
+/**@brief Function for handling the crit command.
+ *
+ * @details crit [reset]: prints, for each critical region call site, how many regions it ran
+ *          and their longest and mean duration in microseconds.
+ */
+static void crit_cmd(uint32_t argc, char ** argv)
+{
+    app_crit_prof_site_t const * p_site;
+    char const *                 p_name;
+
+    if ((argc == 2) && (strcmp(argv[1], "reset") == 0))
+    {
+        app_crit_prof_reset();
+        return;
+    }
+
+    for (p_site = app_crit_prof_sites_get(); p_site != NULL; p_site = p_site->p_next)
+    {
+        p_name = strrchr(p_site->p_file, '/');
+        p_name = (p_name != NULL) ? p_name + 1 : p_site->p_file;
+        SEGGER_RTT_printf(0, "\n\r%s:%u: %u regions, max %u us, mean %u us", p_name, p_site->line,
+                          p_site->count, p_site->max,
+                          (p_site->count != 0) ? p_site->total / p_site->count : 0);
+    }
+}
+#endif
+
+#ifdef APP_IRQ_PROFILE
+
+/**@brief Function for printing a histogram of 2^n microsecond buckets. */
+static void irq_hist_print(char const * p_name, uint16_t max, uint16_t const * p_hist)
+{
+    uint32_t i;
+
+    SEGGER_RTT_printf(0, "\n\r  %s max %u us:", p_name, max);
+    for (i = 0; i < APP_IRQ_PROF_BUCKETS; i++)
+    {
+        SEGGER_RTT_printf(0, " %u", p_hist[i]);
+    }
+}
+
+
+/**@brief Function for handling the irq command.
+ *
+ * @details irq [reset]: prints, for each profiled interrupt handler, how often it ran and how
+ *          deeply nested, and histograms of its execution time and latency. Bucket n counts
+ *          2^(n-1) to 2^n - 1 us.
+ */
+static void irq_cmd(uint32_t argc, char ** argv)
+{
+    app_irq_prof_stats_t const * p_stats;
+
+    if ((argc == 2) && (strcmp(argv[1], "reset") == 0))
+    {
+        app_irq_prof_reset();
+        return;
+    }
+
+    for (p_stats = app_irq_prof_stats_get(); p_stats != NULL; p_stats = p_stats->p_next)
+    {
+        SEGGER_RTT_printf(0, "\n\r%s: %u irqs, %u nested, depth max %u", p_stats->p_name,
+                          p_stats->count, p_stats->nested, p_stats->depth_max);
+        irq_hist_print("exec", p_stats->exec_max, p_stats->exec);
+        if (p_stats->source >= 0)
+        {
+            irq_hist_print("latency", p_stats->latency_max, p_stats->latency);
+        }
+    }
+}
+#endif
+
+
+#ifdef APP_FAULT_ENABLED
+/**@brief Function for printing a fault dump over RTT, one "FAULT <key> <value>" line per item.
+ *
+ * @details The lines are the input of SDK/libraries/fault/host/fault_decode, which looks the
+ *          addresses up in the ELF file.
+ */
+static void fault_print(app_fault_dump_t const * p_dump)
+{
+    static char const * const reg_names[] = {"r0", "r1", "r2", "r3", "r12", "lr", "pc", "xpsr"};
+    uint32_t const *          p_regs      = (uint32_t const *)&p_dump->frame;
+    uint32_t                  i;
+
+    SEGGER_RTT_printf(0, "\n\rFAULT type %s", (p_dump->type == APP_FAULT_TYPE_HARDFAULT) ?
+                                               "hardfault" : "error");
+    SEGGER_RTT_printf(0, "\n\rFAULT reset 0x%08x", p_dump->reset_reason);
+    SEGGER_RTT_printf(0, "\n\rFAULT code 0x%08x", p_dump->error_code);
+    SEGGER_RTT_printf(0, "\n\rFAULT line %u", p_dump->line);
+    // The name is only followed if it points to flash, where the string still is.
+    if ((p_dump->p_file != NULL) &&
+        ((uint32_t)p_dump->p_file < NRF_FICR->CODEPAGESIZE * NRF_FICR->CODESIZE))
+    {
+        SEGGER_RTT_printf(0, "\n\rFAULT file %s", p_dump->p_file);
+    }
+    for (i = 0; i < sizeof(reg_names) / sizeof(reg_names[0]); i++)
+    {
+        SEGGER_RTT_printf(0, "\n\rFAULT %s 0x%08x", reg_names[i], p_regs[i]);
+    }
+    SEGGER_RTT_printf(0, "\n\rFAULT exc_return 0x%08x", p_dump->exc_return);
+    SEGGER_RTT_printf(0, "\n\rFAULT sp 0x%08x", p_dump->sp);
+    for (i = 0; i < p_dump->stack_words; i++)
+    {
+        if ((i % FAULT_STACK_PER_LINE) == 0)
+        {
+            SEGGER_RTT_WriteString(0, "\n\rFAULT stack");
+        }
+        SEGGER_RTT_printf(0, " 0x%08x", p_dump->stack[i]);
+    }
+    SEGGER_RTT_WriteString(0, "\n\r");
+}
+
+
+/**@brief Function for handling the fault command.
+ *
+ * @details fault: prints the dump left by the last fault, if any.
+ *          fault hardfault|error: makes the chip fault, with an unaligned load or with
+ *          APP_ERROR_CHECK, to try out the capture.
+ */
+static void fault_cmd(uint32_t argc, char ** argv)
+{
+    app_fault_dump_t const * p_dump = app_fault_last_get();
+
+    if ((argc == 2) && (strcmp(argv[1], "hardfault") == 0))
+    {
+        // The Cortex-M0 faults on any unaligned word access.
+        (void)*(volatile uint32_t *)0x20000001UL;
+    }
+    else if ((argc == 2) && (strcmp(argv[1], "error") == 0))
+    {
+        APP_ERROR_CHECK(NRF_ERROR_INTERNAL);
+    }
+    else if (p_dump != NULL)
+    {
+        fault_print(p_dump);
+    }
+    else
+    {
+        SEGGER_RTT_WriteString(0, "\n\rno fault since power-on");
+    }
+}
+#endif
+
+
+/**@brief Function for handling the pool command.
+ *
+ * @details pool: prints the usage of each pool and checks the guard words of the blocks in use.
+ */
+static void pool_cmd(uint32_t argc, char ** argv)
+{
+    app_pool_stats_t stats;
+    uint8_t          pool;
+
+    UNUSED_PARAMETER(argc);
+    UNUSED_PARAMETER(argv);
+
+    for (pool = 0; pool < APP_POOL_COUNT; pool++)
+    {
+        (void)app_pool_stats_get(pool, &stats);
+        SEGGER_RTT_printf(0, "\n\rpool %u: %u x %u bytes, used %u, max %u, allocs %u, failed %u",
+                          pool, stats.blocks, stats.block_size, stats.used, stats.used_max,
+                          stats.allocs, stats.failed);
+    }
+    SEGGER_RTT_printf(0, "\n\ruart frames: dropped %u bytes", m_uart_frame_dropped);
+    if (app_pool_check() != NRF_SUCCESS)
+    {
+        SEGGER_RTT_WriteString(0, "\n\rguard word overwritten");
+    }
+}
+
+
+static bool m_stack_painted;                         /**< The startup code painted the stack. */
+
+/**@brief Function for handling the stack command.
+ *
+ * @details stack: prints the deepest stack use since reset, found from the pattern painted by
+ *          the startup code.
+ */
+static void stack_cmd(uint32_t argc, char ** argv)
+{
+    UNUSED_PARAMETER(argc);
+    UNUSED_PARAMETER(argv);
+
+    if (!m_stack_painted)
+    {
+        SEGGER_RTT_WriteString(0, "\n\rstack not painted, define __STARTUP_PAINT_STACK");
+        return;
+    }
+    SEGGER_RTT_printf(0, "\n\rstack: used max %u of %u bytes", app_stack_used_max_get(),
+                      app_stack_size_get());
+}
+
+
+/**@brief Function for handling the off command.
+ */
+static void off_cmd(uint32_t argc, char ** argv)
+{
+    UNUSED_PARAMETER(argc);
+    UNUSED_PARAMETER(argv);
+
+    app_pm_system_off();
+}
+
+
+static app_pt_t m_shell_pt;                          /**< Task polling the shell. */
+static uint32_t m_shell_poll_ms = SHELL_POLL_MIN_MS; /**< Current poll interval. */
+static uint32_t m_shell_idle_ms;                    /**< Time since the last input. */
+
+/**@brief Function for warning over RTT when less than APP_STACK_MARGIN bytes of stack were left.
+ *
+ * @details Each new deepest use inside the margin is reported once.
+ */
+static void stack_watch(void)
+{
+    static uint32_t warned_used;
+    uint32_t        used;
+
+    if (m_stack_painted && (app_stack_check(&used) != NRF_SUCCESS) && (used > warned_used))
+    {
+        warned_used = used;
+        SEGGER_RTT_printf(0, "\n\rWARNING: stack used %u of %u bytes\n\r", used,
+                          app_stack_size_get());
+    }
+}
+
+
+/**@brief Task polling the shell and flushing stdout.
+ *
+ * @details J-Link writes RTT input to RAM without raising an interrupt, so input has to be
+ *          polled. The interval doubles while no input arrives; after SHELL_SYSOFF_IDLE_MS
+ *          the task exits, which leaves no timer running and lets the power manager enter
+ *          System OFF. Each poll also checks the stack high-water mark.
+ */
+static char shell_thread(app_pt_t * p_pt)
+{
+    APP_PT_BEGIN(p_pt);
+    while ((SHELL_SYSOFF_IDLE_MS == 0) || (m_shell_idle_ms < SHELL_SYSOFF_IDLE_MS))
+    {
+        APP_PT_SLEEP(p_pt, APP_TIMER_TICKS(m_shell_poll_ms));
+        if (app_shell_process())
+        {
+            m_shell_poll_ms = SHELL_POLL_MIN_MS;
+            m_shell_idle_ms = 0;
+        }
+        else
+        {
+            m_shell_idle_ms += m_shell_poll_ms;
+            m_shell_poll_ms  = MIN(2 * m_shell_poll_ms, SHELL_POLL_MAX_MS);
+        }
+        stack_watch();
+        app_stdout_flush();
+    }
+    APP_PT_END(p_pt);
+}
+
+
+/**@brief Function for preparing System OFF.
+ */
+static void sysoff_prepare(void)
+{
+    app_led_stop();
+    LEDS_OFF(LEDS_MASK);
+    printf("\n\rSystem OFF, press a button to wake up\n\r");
+    app_stdout_flush();
+}
+
+
+static const app_shell_cmd_t m_cmds[] =
+{
+    {"led",    "on|off|next|toggle <n>|blink <n>|breathe|chase|level|fade", led_cmd},
+    {"stdout", "[rtt|uart|both|none]",    stdout_cmd},
+    {"pm",     "[reset]",                 pm_cmd},
+    {"sched",  "[reset]",                 sched_cmd},
+    {"delay",  "<us>",                    delay_cmd},
+    {"bench",  "hot path cycles",         bench_cmd},
+    {"stack",  "deepest stack use",       stack_cmd},
+    {"pool",   "block pool usage",        pool_cmd},
+#ifdef APP_CRIT_PROFILE
+    {"crit",   "[reset]",                 crit_cmd},
+#endif
+#ifdef APP_IRQ_PROFILE
+    {"irq",    "[reset]",                 irq_cmd},
+#endif
+#ifdef APP_FAULT_ENABLED
+    {"fault",  "[hardfault|error]",       fault_cmd},
+#endif
+    {"off",    "enter System OFF",        off_cmd},
+    {"reset",  "soft reset",              reset_cmd},
+};
+
+static app_shell_cmd_set_t m_cmd_set =
+{
+    m_cmds, sizeof(m_cmds) / sizeof(m_cmds[0]), NULL
+};
+
 
 /**
  * @brief Function for application main entry.
  */
 int main(void)
 {
+    // First, before anything else runs on TIMER2.
+    uint16_t boot_cycles = app_timestamp_boot_cycles_get();
+    uint32_t err_code;
+
+    // Pick up the log and the dump of the last boot before an error in the init below can
+    // record over them.
+#ifdef CRASH_LOG_ENABLED
+    err_code = crash_log_init(crash_log_replay);
+    if (err_code != NRF_ERROR_NOT_FOUND)
+    {
+        SEGGER_RTT_printf(0, "\n\r--- end of log (%s) ---\n\r",
+                          (err_code == NRF_SUCCESS) ? "sealed" : "unsealed");
+    }
+#endif
+#ifdef APP_FAULT_ENABLED
+    // Before app_pm_init(), which clears RESETREAS.
+    bool fault_found = (app_fault_init() == NRF_SUCCESS);
+#endif
+
     // Configure LED-pins as outputs.
     LEDS_CONFIGURE(LEDS_MASK);
 
-    uint32_t err_code;
     const app_uart_comm_params_t comm_params =
       {
           RX_PIN_NUMBER,
@@ -69,6 +918,16 @@ int main(void)
           UART_BAUDRATE_BAUDRATE_Baud115200
       };
 
+    // UART events are handled in thread mode through the scheduler.
+    APP_SCHED_INIT(SCHED_MAX_EVENT_DATA_SIZE, SCHED_QUEUE_SIZE);
+    app_pool_init();
+#if defined(APP_UART_ISR_PROFILE) || defined(APP_CRIT_PROFILE) || defined(APP_IRQ_PROFILE)
+    app_timestamp_init();
+#endif
+#ifdef APP_IRQ_PROFILE
+    app_irq_prof_init();
+#endif
+
     APP_UART_FIFO_INIT(&comm_params,
                          UART_RX_BUF_SIZE,
                          UART_TX_BUF_SIZE,
@@ -78,42 +937,53 @@ int main(void)
 
     APP_ERROR_CHECK(err_code);
 
-    //SEGGER_RTT_Write(0,RTT_CTRL_BG_CYAN,8);
-    SEGGER_RTT_printf(0,"\n\rRunning!\n\r");
-
-    // Toggle LEDs.
-    while (true)
-    {
-	static int i = 0;
-	uint8_t cr;
-
-        //while(app_uart_get(&cr) != NRF_SUCCESS);
-	cr = SEGGER_RTT_WaitKey();
-	if(cr == ' ')
-	{
-            LEDS_INVERT(1 << leds_list[i]);
-	    i++;
-	}
-	else if(cr == 'q')
-	{
-	    LEDS_OFF(LEDS_MASK);
-	    i = 0;
-	}
-	else if(cr == 'Q')
-        {
-            LEDS_ON(LEDS_MASK);
-	    i = 0;
-	}
-	else
-	    SEGGER_RTT_printf(0,"\n\rChar:%c\n\r",cr);
+#ifdef APP_FAULT_ENABLED
+    if (fault_found)
+    {
+        fault_print(app_fault_last_get());
+    }
+#endif
+
+    err_code = app_stdout_init(APP_STDOUT_SINK_RTT);
+    APP_ERROR_CHECK(err_code);
+    m_stack_painted = (app_stack_init() == NRF_SUCCESS);
+
+    err_code = app_timer_init();
+    APP_ERROR_CHECK(err_code);
+    err_code = app_led_init(leds_list, true);
+    APP_ERROR_CHECK(err_code);
+    err_code = app_button_init(buttons_list, BUTTONS_NUMBER, true, button_evt_handler);
+    APP_ERROR_CHECK(err_code);
+    err_code = app_pm_init(sysoff_prepare);
+    APP_ERROR_CHECK(err_code);
+    app_pm_wakeup_pins_set(BUTTONS_MASK);
 
-	if (i == LEDS_NUMBER) i = 0;
-        
-	nrf_delay_ms(500);
-        
+    //SEGGER_RTT_Write(0,RTT_CTRL_BG_CYAN,8);
+    printf("\n\rRunning!%s\n\r", app_pm_woke_from_off() ? " (woke from System OFF)" : "");
+    if (boot_cycles != 0)
+    {
+        printf("boot: %u cycles from reset handler to main\n\r", boot_cycles);
     }
-//        while(app_uart_put(cr) != NRF_SUCCESS);
 
+    err_code = app_shell_register(&m_cmd_set);
+    APP_ERROR_CHECK(err_code);
+    err_code = app_shell_init("WaterLED> ");
+    APP_ERROR_CHECK(err_code);
+
+    err_code = app_pt_init();
+    APP_ERROR_CHECK(err_code);
+    err_code = app_pt_start(&m_shell_pt, shell_thread);
+    APP_ERROR_CHECK(err_code);
+
+    // Work arrives as scheduler events, tasks included; the CPU sleeps in between, with no periodic tick.
+    for (;;)
+    {
+        app_sched_execute();
+#ifdef APP_UART_WITH_SCHEDULER
+        app_uart_evt_pending_process();
+#endif
+        app_pm_sleep();
+    }
 }
 
 
@@ -45,7 +45,7 @@
 #define BUTTONS_INV_MASK  BUTTONS_MASK
 
 #define LEDS_LIST { LED_0, LED_1, LED_2 }
-#define BUTTONS_LIST { BUTTON_0， BUTTON_1 }
+#define BUTTONS_LIST { BUTTON_0, BUTTON_1 }
 #define BUTTONS_NUMBER 2
 #define LEDS_NUMBER    3
 
@@ -0,0 +1,128 @@
+/*********************************************************************
+----------------------------------------------------------------------
+File    : SEGGER_RTT_Host.c
+Purpose : Shared-memory backing for the host build of SEGGER_RTT.c
+          (compiled with SEGGER_RTT_HOST=1).
+---------------------------END-OF-HEADER------------------------------
+*/
+
+#include "SEGGER_RTT_Host.h"
+#include "SEGGER_RTT.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/*********************************************************************
+*
+*       Static data
+*
+**********************************************************************
+*/
+static const char*             _sShmName;
+static SEGGER_RTT_HOST_HEADER* _pHeader;
+
+/*********************************************************************
+*
+*       Static code
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       _Cleanup
+*
+*  Function description
+*    Removes the segment name when the target process exits.
+*    A probe which still has the segment mapped keeps its view.
+*/
+static void _Cleanup(void) {
+  shm_unlink(_sShmName);
+}
+
+/*********************************************************************
+*
+*       Public code
+*
+**********************************************************************
+*/
+
+/*********************************************************************
+*
+*       SEGGER_RTT_HOST_GetMem
+*
+*  Function description
+*    Creates the shared-memory segment and returns the memory for the
+*    RTT control block and buffers. Called once by SEGGER_RTT.c.
+*
+*  Parameters
+*    NumBytes     Number of bytes required after the header.
+*
+*  Return values
+*    Zero-initialized memory. Does not return on failure.
+*/
+void* SEGGER_RTT_HOST_GetMem(unsigned NumBytes) {
+  SEGGER_RTT_HOST_HEADER* pHeader;
+  size_t                  Size;
+  int                     fd;
+
+  _sShmName = getenv(SEGGER_RTT_HOST_ENV_SHM_NAME);
+  if (_sShmName == NULL) {
+    _sShmName = SEGGER_RTT_HOST_SHM_NAME;
+  }
+  Size = sizeof(SEGGER_RTT_HOST_HEADER) + NumBytes;
+  shm_unlink(_sShmName);                                              // Start from a zeroed segment, never reuse a stale one
+  fd = shm_open(_sShmName, O_RDWR | O_CREAT | O_EXCL, 0600);
+  if ((fd < 0) || (ftruncate(fd, (off_t)Size) != 0)) {
+    perror("SEGGER_RTT_HOST_GetMem: shm");
+    exit(EXIT_FAILURE);
+  }
+  pHeader = (SEGGER_RTT_HOST_HEADER*)mmap(NULL, Size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (pHeader == MAP_FAILED) {
+    perror("SEGGER_RTT_HOST_GetMem: mmap");
+    exit(EXIT_FAILURE);
+  }
+  atexit(_Cleanup);
+  pHeader->TargetBase = (uint64_t)(uintptr_t)(pHeader + 1);
+  pHeader->NumBytes   = NumBytes;
+  __sync_synchronize();
+  memcpy(pHeader->acMagic, SEGGER_RTT_HOST_MAGIC, sizeof(pHeader->acMagic));
+  _pHeader = pHeader;
+  return pHeader + 1;
+}
+
+/*********************************************************************
+*
+*       SEGGER_RTT_HOST_WaitForProbe
+*
+*  Function description
+*    Waits until a probe has attached to the segment, so that a short
+*    run does not finish before anybody reads its output.
+*    On hardware, the debugger is simply connected before the target runs.
+*
+*  Parameters
+*    TimeoutMs    Maximum time to wait in milliseconds, 0 waits forever.
+*
+*  Return values
+*    1  Probe attached.
+*    0  Timeout.
+*/
+int SEGGER_RTT_HOST_WaitForProbe(unsigned TimeoutMs) {
+  unsigned Ms;
+
+  SEGGER_RTT_Init();
+  for (Ms = 0; (TimeoutMs == 0) || (Ms < TimeoutMs); Ms++) {
+    if (_pHeader->ProbeAttached) {
+      return 1;
+    }
+    usleep(1000);
+  }
+  return 0;
+}
+
+/*************************** End of file ****************************/
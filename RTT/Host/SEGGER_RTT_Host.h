@@ -0,0 +1,55 @@
+/*********************************************************************
+----------------------------------------------------------------------
+File    : SEGGER_RTT_Host.h
+Purpose : Host build of RTT: the control block and buffers are placed
+          in a POSIX shared-memory segment, where a probe process
+          (rtt_probe) finds and services them the way J-Link does on
+          the target.
+---------------------------END-OF-HEADER------------------------------
+*/
+
+#ifndef SEGGER_RTT_HOST_H
+#define SEGGER_RTT_HOST_H
+
+#include <stdint.h>
+
+/*********************************************************************
+*
+*       Defines
+*
+**********************************************************************
+*/
+#define SEGGER_RTT_HOST_MAGIC         "RTTSHM1"       // Written last by the target once the segment is set up
+#define SEGGER_RTT_HOST_SHM_NAME      "/segger_rtt"   // Default segment name, overridden by environment variable RTT_SHM
+#define SEGGER_RTT_HOST_ENV_SHM_NAME  "RTT_SHM"
+
+/*********************************************************************
+*
+*       Types
+*
+**********************************************************************
+*/
+//
+// Header at the start of the shared-memory segment.
+// Pointers in the RTT control block are addresses in the target process;
+// the probe translates them with TargetBase, just as J-Link uses target addresses.
+//
+typedef struct {
+  char              acMagic[8];       // SEGGER_RTT_HOST_MAGIC
+  uint64_t          TargetBase;       // Address of the first byte after this header in the target process
+  uint32_t          NumBytes;         // Number of bytes after this header
+  volatile uint32_t ProbeAttached;    // Set by the probe once it has found the control block
+} SEGGER_RTT_HOST_HEADER;
+
+/*********************************************************************
+*
+*       API functions
+*
+**********************************************************************
+*/
+void* SEGGER_RTT_HOST_GetMem      (unsigned NumBytes);
+int   SEGGER_RTT_HOST_WaitForProbe(unsigned TimeoutMs);
+
+#endif
+
+/*************************** End of file ****************************/
@@ -0,0 +1,178 @@
+/*********************************************************************
+----------------------------------------------------------------------
+File    : rtt_host_target.c
+Purpose : Host program standing in for the firmware side of RTT.
+          Either writes a number of log lines as fast as possible in
+          the selected SEGGER_RTT_MODE_* and reports how many bytes
+          RTT accepted, or echoes lines received on down-buffer 0.
+          Run together with rtt_probe.
+---------------------------END-OF-HEADER------------------------------
+*/
+
+#include "SEGGER_RTT.h"
+#include "SEGGER_RTT_Host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*********************************************************************
+*
+*       Static code
+*
+**********************************************************************
+*/
+
+static double _Now(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void _Usage(void) {
+  fprintf(stderr,
+    "usage: rtt_host_target [-m skip|trim|block] [-n lines] [-p] [-w]\n"
+    "  -m mode   up-buffer 0 mode (default: skip)\n"
+    "  -n lines  write this many log lines, print statistics and exit;\n"
+    "            without -n, echo lines received from the probe until \"quit\"\n"
+    "  -p        format the lines with SEGGER_RTT_printf instead of SEGGER_RTT_Write\n"
+    "  -w        wait for rtt_probe to attach before starting\n");
+}
+
+/*********************************************************************
+*
+*       _Flood
+*
+*  Function description
+*    Writes NumLines log lines and reports how many bytes RTT accepted.
+*/
+static void _Flood(unsigned NumLines, int UsePrintf) {
+  static const char acLine[] = "[00000000] the quick brown fox jumps over the lazy dog\n";
+  unsigned long long NumBytesOffered;
+  unsigned long long NumBytesAccepted;
+  unsigned           i;
+  int                r;
+  double             t;
+
+  NumBytesOffered  = 0;
+  NumBytesAccepted = 0;
+  t = _Now();
+  for (i = 0; i < NumLines; i++) {
+    if (UsePrintf) {
+      r = SEGGER_RTT_printf(0, "[%08X] the quick brown fox jumps over the lazy dog\n", i);
+    } else {
+      r = SEGGER_RTT_Write(0, acLine, sizeof(acLine) - 1);
+    }
+    if (r > 0) {
+      NumBytesAccepted += r;
+    }
+    NumBytesOffered += sizeof(acLine) - 1;
+  }
+  t = _Now() - t;
+  fprintf(stderr, "rtt_host_target: %u lines, %llu of %llu bytes accepted in %.3f s (%.1f ns/line)\n",
+          NumLines, NumBytesAccepted, NumBytesOffered, t, (NumLines != 0) ? (t * 1e9 / NumLines) : 0.0);
+}
+
+/*********************************************************************
+*
+*       _Echo
+*
+*  Function description
+*    Echoes lines received on down-buffer 0 until "quit" is received.
+*/
+static void _Echo(void) {
+  char     acLine[64];
+  unsigned Len;
+  int      c;
+
+  SEGGER_RTT_WriteString(0, "rtt_host_target: echo mode, \"quit\" to exit\n");
+  Len = 0;
+  for (;;) {
+    c = SEGGER_RTT_GetKey();
+    if (c < 0) {
+      usleep(1000);
+      continue;
+    }
+    if ((c != '\n') && (c != '\r')) {
+      if (Len < sizeof(acLine) - 1) {
+        acLine[Len++] = (char)c;
+      }
+      continue;
+    }
+    acLine[Len] = '\0';
+    if (strcmp(acLine, "quit") == 0) {
+      break;
+    }
+    if (Len != 0) {
+      SEGGER_RTT_printf(0, "echo: %s\n", acLine);
+    }
+    Len = 0;
+  }
+}
+
+/*********************************************************************
+*
+*       Public code
+*
+**********************************************************************
+*/
+
+int main(int argc, char* argv[]) {
+  unsigned NumLines;
+  int      HaveLines;
+  int      UsePrintf;
+  int      Wait;
+  int      Mode;
+  int      c;
+
+  Mode      = SEGGER_RTT_MODE_NO_BLOCK_SKIP;
+  NumLines  = 0;
+  HaveLines = 0;
+  UsePrintf = 0;
+  Wait      = 0;
+  while ((c = getopt(argc, argv, "m:n:pwh")) != -1) {
+    switch (c) {
+    case 'm':
+      if (strcmp(optarg, "skip") == 0) {
+        Mode = SEGGER_RTT_MODE_NO_BLOCK_SKIP;
+      } else if (strcmp(optarg, "trim") == 0) {
+        Mode = SEGGER_RTT_MODE_NO_BLOCK_TRIM;
+      } else if (strcmp(optarg, "block") == 0) {
+        Mode = SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL;
+      } else {
+        _Usage();
+        return EXIT_FAILURE;
+      }
+      break;
+    case 'n':
+      NumLines  = strtoul(optarg, NULL, 0);
+      HaveLines = 1;
+      break;
+    case 'p':
+      UsePrintf = 1;
+      break;
+    case 'w':
+      Wait = 1;
+      break;
+    default:
+      _Usage();
+      return EXIT_FAILURE;
+    }
+  }
+  SEGGER_RTT_Init();
+  SEGGER_RTT_ConfigUpBuffer(0, NULL, NULL, 0, Mode);
+  if (Wait) {
+    SEGGER_RTT_HOST_WaitForProbe(0);
+  }
+  if (HaveLines) {
+    _Flood(NumLines, UsePrintf);
+  } else {
+    _Echo();
+  }
+  return EXIT_SUCCESS;
+}
+
+/*************************** End of file ****************************/
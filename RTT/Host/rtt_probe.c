@@ -0,0 +1,379 @@
+/*********************************************************************
+----------------------------------------------------------------------
+File    : rtt_probe.c
+Purpose : Stand-in for the J-Link RTT client on Linux. Attaches to the
+          shared-memory segment of a host build of SEGGER_RTT.c,
+          locates the RTT control block by its ID and services
+          channel 0 by polling WrOff/RdOff:
+            up-buffer 0   -> stdout
+            stdin         -> down-buffer 0
+          Exits when the target process has exited and everything it
+          wrote has been read.
+---------------------------END-OF-HEADER------------------------------
+*/
+
+#include "SEGGER_RTT_Host.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/*********************************************************************
+*
+*       Types
+*
+**********************************************************************
+*/
+//
+// Layout of the RTT control block as seen by the probe.
+// Like J-Link, the probe only relies on the documented layout, not on SEGGER_RTT.c.
+//
+typedef struct {
+  uintptr_t    sName;
+  uintptr_t    pBuffer;                 // Target address
+  int          SizeOfBuffer;
+  volatile int WrOff;
+  volatile int RdOff;
+  int          Flags;
+} PROBE_RING_BUFFER;
+
+typedef struct {
+  char              acID[16];
+  int               MaxNumUpBuffers;
+  int               MaxNumDownBuffers;
+  PROBE_RING_BUFFER aBuffer[];          // MaxNumUpBuffers up-buffers, followed by MaxNumDownBuffers down-buffers
+} PROBE_RTT_CB;
+
+typedef struct {
+  SEGGER_RTT_HOST_HEADER* pHeader;
+  char*                   pMem;         // Probe address of target address TargetBase
+  size_t                  NumBytes;
+  ino_t                   Inode;        // Identifies the segment, to notice when the target is gone
+} PROBE_TARGET;
+
+/*********************************************************************
+*
+*       Static data
+*
+**********************************************************************
+*/
+static volatile sig_atomic_t _Stop;
+
+/*********************************************************************
+*
+*       Static code
+*
+**********************************************************************
+*/
+
+static void _OnSignal(int Sig) {
+  (void)Sig;
+  _Stop = 1;
+}
+
+static double _Now(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*********************************************************************
+*
+*       _Attach
+*
+*  Function description
+*    Waits for the target to create and set up the segment, then maps it.
+*/
+static int _Attach(const char* sName, PROBE_TARGET* pTarget) {
+  struct stat st;
+  void*       p;
+  int         fd;
+
+  for (;;) {
+    if (_Stop) {
+      return -1;
+    }
+    fd = shm_open(sName, O_RDWR, 0);
+    if (fd >= 0) {
+      if ((fstat(fd, &st) == 0) && ((size_t)st.st_size > sizeof(SEGGER_RTT_HOST_HEADER))) {
+        break;
+      }
+      close(fd);
+    }
+    usleep(1000);
+  }
+  p = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    perror("rtt_probe: mmap");
+    return -1;
+  }
+  pTarget->pHeader = (SEGGER_RTT_HOST_HEADER*)p;
+  while (memcmp(pTarget->pHeader->acMagic, SEGGER_RTT_HOST_MAGIC, sizeof(pTarget->pHeader->acMagic)) != 0) {
+    if (_Stop) {
+      return -1;
+    }
+    usleep(1000);
+  }
+  __sync_synchronize();
+  pTarget->pMem     = (char*)(pTarget->pHeader + 1);
+  pTarget->NumBytes = st.st_size - sizeof(SEGGER_RTT_HOST_HEADER);
+  pTarget->Inode    = st.st_ino;
+  return 0;
+}
+
+/*********************************************************************
+*
+*       _FindCB
+*
+*  Function description
+*    Searches the segment for the control block ID, as J-Link searches target RAM.
+*/
+static PROBE_RTT_CB* _FindCB(PROBE_TARGET* pTarget) {
+  size_t Off;
+
+  while (!_Stop) {
+    for (Off = 0; Off + sizeof(PROBE_RTT_CB) <= pTarget->NumBytes; Off += sizeof(uintptr_t)) {
+      if (memcmp(pTarget->pMem + Off, "SEGGER RTT", 11) == 0) {
+        __sync_synchronize();
+        return (PROBE_RTT_CB*)(pTarget->pMem + Off);
+      }
+    }
+    usleep(1000);
+  }
+  return NULL;
+}
+
+/*********************************************************************
+*
+*       _GetBuffer
+*
+*  Function description
+*    Translates the buffer address of a ring buffer into a probe address.
+*/
+static char* _GetBuffer(PROBE_TARGET* pTarget, PROBE_RING_BUFFER* pRing) {
+  uint64_t Off;
+
+  Off = (uint64_t)pRing->pBuffer - pTarget->pHeader->TargetBase;
+  if ((pRing->SizeOfBuffer <= 0) || (Off + (uint64_t)pRing->SizeOfBuffer > pTarget->NumBytes)) {
+    return NULL;                                                        // Buffer not in the shared segment
+  }
+  return pTarget->pMem + Off;
+}
+
+/*********************************************************************
+*
+*       _TargetAlive
+*
+*  Function description
+*    The target removes the segment name when it exits.
+*/
+static int _TargetAlive(const char* sName, PROBE_TARGET* pTarget) {
+  struct stat st;
+  int         fd;
+  int         r;
+
+  fd = shm_open(sName, O_RDONLY, 0);
+  if (fd < 0) {
+    return 0;
+  }
+  r = (fstat(fd, &st) == 0) && (st.st_ino == pTarget->Inode);
+  close(fd);
+  return r;
+}
+
+/*********************************************************************
+*
+*       _ReadUp
+*
+*  Function description
+*    Copies new data from an up-buffer to fd and advances RdOff.
+*
+*  Return values
+*    Number of bytes read.
+*/
+static int _ReadUp(PROBE_TARGET* pTarget, PROBE_RING_BUFFER* pRing, int fd) {
+  char* pBuffer;
+  int   RdOff;
+  int   WrOff;
+  int   NumBytes;
+  int   Total;
+
+  pBuffer = _GetBuffer(pTarget, pRing);
+  if (pBuffer == NULL) {
+    return 0;
+  }
+  Total = 0;
+  RdOff = pRing->RdOff;
+  WrOff = pRing->WrOff;
+  while (RdOff != WrOff) {
+    NumBytes = (WrOff > RdOff) ? (WrOff - RdOff) : (pRing->SizeOfBuffer - RdOff);
+    if ((fd >= 0) && (write(fd, pBuffer + RdOff, NumBytes) < 0)) {
+      fd = -1;                                                          // Keep draining so the target does not stall
+    }
+    Total += NumBytes;
+    RdOff += NumBytes;
+    if (RdOff == pRing->SizeOfBuffer) {
+      RdOff = 0;
+    }
+  }
+  __sync_synchronize();                                                 // Data has been consumed before the target may reuse it
+  pRing->RdOff = RdOff;
+  return Total;
+}
+
+/*********************************************************************
+*
+*       _WriteDown
+*
+*  Function description
+*    Moves pending bytes from fd into a down-buffer and advances WrOff.
+*
+*  Return values
+*    >= 0  Number of bytes written.
+*     < 0  End of input.
+*/
+static int _WriteDown(PROBE_TARGET* pTarget, PROBE_RING_BUFFER* pRing, int fd) {
+  struct pollfd pfd;
+  char*         pBuffer;
+  int           RdOff;
+  int           WrOff;
+  int           NumBytes;
+  ssize_t       r;
+
+  pBuffer = _GetBuffer(pTarget, pRing);
+  if (pBuffer == NULL) {
+    return 0;
+  }
+  RdOff = pRing->RdOff;
+  WrOff = pRing->WrOff;
+  if (RdOff > WrOff) {
+    NumBytes = RdOff - WrOff - 1;
+  } else {
+    NumBytes = pRing->SizeOfBuffer - WrOff - (RdOff == 0);
+  }
+  pfd.fd     = fd;
+  pfd.events = POLLIN;
+  if ((NumBytes <= 0) || (poll(&pfd, 1, 0) <= 0)) {
+    return 0;
+  }
+  r = read(fd, pBuffer + WrOff, NumBytes);
+  if (r <= 0) {
+    return (r == 0 || errno != EINTR) ? -1 : 0;
+  }
+  WrOff += (int)r;
+  if (WrOff == pRing->SizeOfBuffer) {
+    WrOff = 0;
+  }
+  __sync_synchronize();                                                 // Data is in place before the target can see it
+  pRing->WrOff = WrOff;
+  return (int)r;
+}
+
+static void _Usage(void) {
+  fprintf(stderr,
+    "usage: rtt_probe [-n name] [-i poll_us] [-q] [-s]\n"
+    "  -n name     shared-memory segment (default: $" SEGGER_RTT_HOST_ENV_SHM_NAME " or " SEGGER_RTT_HOST_SHM_NAME ")\n"
+    "  -i poll_us  polling interval while idle in microseconds (default: 1000)\n"
+    "  -q          discard up-buffer data instead of writing it to stdout\n"
+    "  -s          print throughput statistics to stderr on exit\n");
+}
+
+/*********************************************************************
+*
+*       Public code
+*
+**********************************************************************
+*/
+
+int main(int argc, char* argv[]) {
+  PROBE_TARGET       Target;
+  PROBE_RTT_CB*      pCB;
+  PROBE_RING_BUFFER* pDown;
+  const char*        sName;
+  unsigned long      PollUs;
+  unsigned long long NumBytesUp;
+  double             tStart;
+  double             tLast;
+  int                InputOpen;
+  int                Quiet;
+  int                Stats;
+  int                Idle;
+  int                NumBytes;
+  int                c;
+
+  sName  = getenv(SEGGER_RTT_HOST_ENV_SHM_NAME);
+  sName  = (sName != NULL) ? sName : SEGGER_RTT_HOST_SHM_NAME;
+  PollUs = 1000;
+  Quiet  = 0;
+  Stats  = 0;
+  while ((c = getopt(argc, argv, "n:i:qsh")) != -1) {
+    switch (c) {
+    case 'n': sName  = optarg;                      break;
+    case 'i': PollUs = strtoul(optarg, NULL, 0);    break;
+    case 'q': Quiet  = 1;                           break;
+    case 's': Stats  = 1;                           break;
+    default:  _Usage();                             return EXIT_FAILURE;
+    }
+  }
+  signal(SIGINT,  _OnSignal);
+  signal(SIGTERM, _OnSignal);
+  if (_Attach(sName, &Target) != 0) {
+    return EXIT_FAILURE;
+  }
+  pCB = _FindCB(&Target);
+  if (pCB == NULL) {
+    return EXIT_FAILURE;
+  }
+  Target.pHeader->ProbeAttached = 1;
+  pDown      = &pCB->aBuffer[pCB->MaxNumUpBuffers];
+  InputOpen  = 1;
+  NumBytesUp = 0;
+  tStart     = _Now();
+  tLast      = tStart;
+  Idle       = 0;
+  while (!_Stop) {
+    NumBytes = _ReadUp(&Target, &pCB->aBuffer[0], Quiet ? -1 : STDOUT_FILENO);
+    if (NumBytes > 0) {
+      NumBytesUp += NumBytes;
+      tLast       = _Now();
+    }
+    if (InputOpen && (pCB->MaxNumDownBuffers > 0)) {
+      if (_WriteDown(&Target, pDown, STDIN_FILENO) < 0) {
+        InputOpen = 0;
+      }
+    }
+    if (NumBytes > 0) {
+      Idle = 0;
+      continue;                                                         // Keep up with a busy target, like J-Link does
+    }
+    //
+    // Check now and then whether the target has exited. Its data is still readable
+    // through our mapping, so one more pass picks up anything written last.
+    //
+    if ((++Idle & 0x3F) == 0) {
+      if (!_TargetAlive(sName, &Target)) {
+        NumBytesUp += _ReadUp(&Target, &pCB->aBuffer[0], Quiet ? -1 : STDOUT_FILENO);
+        break;
+      }
+    }
+    usleep(PollUs);
+  }
+  if (Stats) {
+    double t = tLast - tStart;
+    fprintf(stderr, "rtt_probe: %llu bytes in %.3f s (%.1f KiB/s)\n",
+            NumBytesUp, t, (t > 0) ? (NumBytesUp / 1024.0 / t) : 0.0);
+  }
+  return EXIT_SUCCESS;
+}
+
+/*************************** End of file ****************************/
@@ -61,10 +61,22 @@ Purpose : Implementation of SEGGER real-time terminal (RTT) which allows
   #define SEGGER_RTT_UNLOCK()
 #endif
 
+#ifndef   SEGGER_RTT_MIRROR
+  #define SEGGER_RTT_MIRROR(pData, NumBytes)             // Receives a copy of everything written to up-buffer 0, even if the host does not read it
+#endif
+
 #ifndef   SEGGER_RTT_IN_RAM
   #define SEGGER_RTT_IN_RAM                               (0)
 #endif
 
+#ifndef   SEGGER_RTT_HOST
+  #define SEGGER_RTT_HOST                                 (0)     // Host build: control block and buffers are shared with a probe process (see RTT/Host)
+#endif
+
+#if SEGGER_RTT_HOST
+  #include "SEGGER_RTT_Host.h"
+#endif
+
 /*********************************************************************
 *
 *       Defines, fixed
@@ -123,6 +135,23 @@ typedef struct {
 *
 **********************************************************************
 */
+#if SEGGER_RTT_HOST
+//
+// Control block and buffers for channel 0 are allocated in shared memory on first use,
+// so that a probe process can find and access them just like J-Link does on the target
+//
+typedef struct {
+  SEGGER_RTT_CB CB;
+  char          acUpBuffer  [BUFFER_SIZE_UP];
+  char          acDownBuffer[BUFFER_SIZE_DOWN];
+} SEGGER_RTT_HOST_MEM;
+
+static SEGGER_RTT_HOST_MEM* _pHostMem;
+
+#define _SEGGER_RTT     (_pHostMem->CB)
+#define _acUpBuffer     (_pHostMem->acUpBuffer)
+#define _acDownBuffer   (_pHostMem->acDownBuffer)
+#else
 //
 // Allocate buffers for channel 0
 //
@@ -143,6 +172,8 @@ static SEGGER_RTT_CB _SEGGER_RTT = {
   {{ "Terminal", &_acDownBuffer[0], sizeof(_acDownBuffer), 0, 0, SEGGER_RTT_MODE_NO_BLOCK_SKIP }},
 };
 
+#endif
+
 static char _ActiveTerminal;
 
 /*********************************************************************
@@ -195,6 +226,23 @@ static int _strlen(const char* s) {
 *    RTT Control Block Structure in the data segment.
 */
 static void _Init(void) {
+#if SEGGER_RTT_HOST
+  if (_pHostMem == NULL) {
+    _pHostMem = (SEGGER_RTT_HOST_MEM*)SEGGER_RTT_HOST_GetMem(sizeof(SEGGER_RTT_HOST_MEM));
+    _SEGGER_RTT.MaxNumUpBuffers        = SEGGER_RTT_MAX_NUM_UP_BUFFERS;
+    _SEGGER_RTT.MaxNumDownBuffers      = SEGGER_RTT_MAX_NUM_DOWN_BUFFERS;
+    _SEGGER_RTT.aUp[0].sName           = "Terminal";
+    _SEGGER_RTT.aUp[0].pBuffer         = &_acUpBuffer[0];
+    _SEGGER_RTT.aUp[0].SizeOfBuffer    = sizeof(_acUpBuffer);
+    _SEGGER_RTT.aUp[0].Flags           = SEGGER_RTT_MODE_NO_BLOCK_SKIP;
+    _SEGGER_RTT.aDown[0].sName         = "Terminal";
+    _SEGGER_RTT.aDown[0].pBuffer       = &_acDownBuffer[0];
+    _SEGGER_RTT.aDown[0].SizeOfBuffer  = sizeof(_acDownBuffer);
+    _SEGGER_RTT.aDown[0].Flags         = SEGGER_RTT_MODE_NO_BLOCK_SKIP;
+    __sync_synchronize();
+    MEMCPY(_SEGGER_RTT.acID, "SEGGER RTT", 11);                      // ID last: the probe must not find a half-initialized control block
+  }
+#endif
 #if SEGGER_RTT_IN_RAM
   if (_SEGGER_RTT.acID[10] == 'I') {
     _SEGGER_RTT.acID[10] = '\0';
@@ -302,6 +350,12 @@ int SEGGER_RTT_Write(unsigned BufferIndex, const char* pBuffer, unsigned NumByte
   SEGGER_RTT_LOCK();
   _Init();
   //
+  // Mirror terminal output before anything is dropped for lack of space
+  //
+  if (BufferIndex == 0) {
+    SEGGER_RTT_MIRROR(pBuffer, NumBytes);
+  }
+  //
   // In case we are not in blocking mode,
   // we need to calculate, how many bytes we can put into the buffer at all.
   //
@@ -355,6 +409,76 @@ int SEGGER_RTT_Write(unsigned BufferIndex, const char* pBuffer, unsigned NumByte
   return NumBytesWritten;
 }
 
+/*********************************************************************
+*
+*       SEGGER_RTT_GetWriteSpan
+*
+*  Function description
+*    Returns the largest block of free space in an up-buffer which
+*    can be written without wrapping around.
+*    Allows formatting routines to generate their output directly
+*    into the RTT buffer instead of copying it from a local buffer.
+*
+*  Parameters
+*    BufferIndex  Index of "Up"-buffer to be used. (e.g. 0 for "Terminal")
+*    ppSpan       Receives the address of the first free byte.
+*
+*  Return values
+*    Number of bytes which may be written at *ppSpan.
+*
+*  Notes
+*    (1) Data written to the span is not visible to the host until
+*        SEGGER_RTT_CommitWrite() is called.
+*    (2) No other write to the same up-buffer may take place between
+*        SEGGER_RTT_GetWriteSpan() and SEGGER_RTT_CommitWrite().
+*/
+int SEGGER_RTT_GetWriteSpan(unsigned BufferIndex, char** ppSpan) {
+  int NumBytesFree;
+  int RdOff;
+  int WrOff;
+
+  _Init();
+  RdOff = _SEGGER_RTT.aUp[BufferIndex].RdOff;                          // May be changed by host (debug probe) in the meantime
+  WrOff = _SEGGER_RTT.aUp[BufferIndex].WrOff;
+  if (RdOff > WrOff) {
+    NumBytesFree = RdOff - WrOff - 1;
+  } else {
+    NumBytesFree = _SEGGER_RTT.aUp[BufferIndex].SizeOfBuffer - WrOff;
+    if (RdOff == 0) {
+      NumBytesFree--;                                                  // Last byte must stay free to tell a full buffer from an empty one
+    }
+  }
+  *ppSpan = _SEGGER_RTT.aUp[BufferIndex].pBuffer + WrOff;
+  return NumBytesFree;
+}
+
+/*********************************************************************
+*
+*       SEGGER_RTT_CommitWrite
+*
+*  Function description
+*    Makes data which has been stored in the span returned by
+*    SEGGER_RTT_GetWriteSpan() visible to the host.
+*
+*  Parameters
+*    BufferIndex  Index of "Up"-buffer to be used. (e.g. 0 for "Terminal")
+*    NumBytes     Number of bytes which have been stored in the span.
+*                 Must not exceed the size returned by SEGGER_RTT_GetWriteSpan().
+*/
+void SEGGER_RTT_CommitWrite(unsigned BufferIndex, unsigned NumBytes) {
+  int WrOff;
+
+  WrOff = _SEGGER_RTT.aUp[BufferIndex].WrOff;
+  if (BufferIndex == 0) {
+    SEGGER_RTT_MIRROR(_SEGGER_RTT.aUp[0].pBuffer + WrOff, NumBytes);
+  }
+  WrOff += NumBytes;
+  if (WrOff == _SEGGER_RTT.aUp[BufferIndex].SizeOfBuffer) {
+    WrOff = 0;
+  }
+  _SEGGER_RTT.aUp[BufferIndex].WrOff = WrOff;
+}
+
 /*********************************************************************
 *
 *       SEGGER_RTT_WriteString
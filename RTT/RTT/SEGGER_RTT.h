@@ -80,6 +80,8 @@ Purpose : Implementation of SEGGER real-time terminal which allows
 int     SEGGER_RTT_Read             (unsigned BufferIndex,       char* pBuffer, unsigned BufferSize);
 int     SEGGER_RTT_Write            (unsigned BufferIndex, const char* pBuffer, unsigned NumBytes);
 int     SEGGER_RTT_WriteString      (unsigned BufferIndex, const char* s);
+int     SEGGER_RTT_GetWriteSpan     (unsigned BufferIndex, char** ppSpan);
+void    SEGGER_RTT_CommitWrite      (unsigned BufferIndex, unsigned NumBytes);
 
 int     SEGGER_RTT_GetKey           (void);
 int     SEGGER_RTT_WaitKey          (void);
@@ -31,6 +31,7 @@ Purpose : Implementation of SEGGER real-time terminal which allows
 #define BUFFER_SIZE_DOWN                          (16)    // Size of the buffer for terminal input to target from host (Usually keyboard input) (Default: 16)
 
 #define SEGGER_RTT_PRINTF_BUFFER_SIZE             (64)    // Size of buffer for RTT printf to bulk-send chars via RTT     (Default: 64)
+#define SEGGER_RTT_PRINTF_DIRECT                  (1)     // RTT printf formats directly into the up-buffer if possible   (Default: 1)
 
 //
 // Target is not allowed to perform other RTT operations while string still has not been stored completely.
@@ -40,6 +41,16 @@ Purpose : Implementation of SEGGER real-time terminal which allows
 #define SEGGER_RTT_LOCK()
 #define SEGGER_RTT_UNLOCK()
 
+//
+// SEGGER_RTT_MIRROR(pData, NumBytes) receives a copy of all output written to up-buffer 0.
+// With CRASH_LOG_ENABLED, the output is mirrored into a RAM ring which survives a reset (see crash_log.h).
+// The mirror is called with the RTT lock held.
+//
+#ifdef CRASH_LOG_ENABLED
+#include "crash_log.h"
+#define SEGGER_RTT_MIRROR(pData, NumBytes)  crash_log_write((pData), (NumBytes))
+#endif
+
 //
 // Define SEGGER_RTT_IN_RAM as 1
 // when using RTT in RAM targets (init and data section both in RAM).
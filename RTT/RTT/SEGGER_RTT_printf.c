@@ -28,6 +28,10 @@ Purpose : Replacement for printf to write formatted data via RTT
   #define SEGGER_RTT_PRINTF_BUFFER_SIZE (64)
 #endif
 
+#ifndef SEGGER_RTT_PRINTF_DIRECT
+  #define SEGGER_RTT_PRINTF_DIRECT      (1)     // Format directly into the up-buffer when it has at least SEGGER_RTT_PRINTF_BUFFER_SIZE contiguous bytes free
+#endif
+
 #include <stdlib.h>
 #include <stdarg.h>
 
@@ -37,6 +41,8 @@ Purpose : Replacement for printf to write formatted data via RTT
 #define FORMAT_FLAG_PRINT_SIGN     (1 << 2)
 #define FORMAT_FLAG_ALTERNATE      (1 << 3)
 
+#define MAX_NUM_DIGITS             (10)         // Digits of the largest 32-bit value in base 10
+
 /*********************************************************************
 *
 *       Types
@@ -45,15 +51,36 @@ Purpose : Replacement for printf to write formatted data via RTT
 */
 
 typedef struct {
-  char* pBuffer;
+  char* pBuffer;                // Current output window. Either free space in the RTT up-buffer or pStage
   int   BufferSize;
   int   Cnt;
 
-  int   ReturnValue;
+  int   ReturnValue;            // Number of bytes already passed on to RTT, < 0 on error
 
   unsigned RTTBufferIndex;
+
+  char* pStage;                 // Local buffer, used when the up-buffer has not enough contiguous space
+  int   IsDirect;
 } SEGGER_RTT_PRINTF_DESC;
 
+/*********************************************************************
+*
+*       Static const
+*
+**********************************************************************
+*/
+
+static const char _aV2C[16] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
+
+//
+// Cortex-M0 has no divide instruction, so decimal digits are
+// generated by repeated subtraction of powers of ten instead.
+//
+static const unsigned _aPow10[MAX_NUM_DIGITS] = {
+  1000000000u, 100000000u, 10000000u, 1000000u, 100000u,
+  10000u,      1000u,      100u,      10u,      1u
+};
+
 /*********************************************************************
 *
 *       Function prototypes
@@ -70,176 +97,260 @@ int SEGGER_RTT_vprintf(unsigned BufferIndex, const char * sFormat, va_list * pPa
 */
 /*********************************************************************
 *
-*       _StoreChar
+*       _OpenWindow
+*
+*  Function description
+*    Selects where the next characters are stored: directly in the
+*    RTT up-buffer if it has enough contiguous space, otherwise in the
+*    local stage buffer which is copied by SEGGER_RTT_Write().
 */
-static void _StoreChar(SEGGER_RTT_PRINTF_DESC * p, char c) {
-  int Cnt;
+static void _OpenWindow(SEGGER_RTT_PRINTF_DESC * p) {
+#if SEGGER_RTT_PRINTF_DIRECT
+  char* pSpan;
+  int   NumBytesFree;
 
-  Cnt = p->Cnt;
-  if ((Cnt + 1) <= p->BufferSize) {
-    *(p->pBuffer + Cnt) = c;
-    p->Cnt = Cnt + 1;
-    p->ReturnValue++;
+  NumBytesFree = SEGGER_RTT_GetWriteSpan(p->RTTBufferIndex, &pSpan);
+  if (NumBytesFree >= SEGGER_RTT_PRINTF_BUFFER_SIZE) {
+    p->pBuffer    = pSpan;
+    p->BufferSize = NumBytesFree;
+    p->IsDirect   = 1;
+    return;
   }
-  //
-  // Write part of string, when the buffer is full
-  //
-  if (p->Cnt == p->BufferSize) {
-    if (SEGGER_RTT_Write(p->RTTBufferIndex, p->pBuffer, p->Cnt) != p->Cnt) {
+#endif
+  p->pBuffer    = p->pStage;
+  p->BufferSize = SEGGER_RTT_PRINTF_BUFFER_SIZE;
+  p->IsDirect   = 0;
+}
+
+/*********************************************************************
+*
+*       _Commit
+*
+*  Function description
+*    Passes the characters of the current window on to RTT.
+*/
+static void _Commit(SEGGER_RTT_PRINTF_DESC * p) {
+  if (p->Cnt != 0) {
+    if (p->IsDirect) {
+      SEGGER_RTT_CommitWrite(p->RTTBufferIndex, p->Cnt);
+    } else if (SEGGER_RTT_Write(p->RTTBufferIndex, p->pBuffer, p->Cnt) != p->Cnt) {
       p->ReturnValue = -1;
-    } else {
-      p->Cnt = 0;
+      return;
     }
+    p->ReturnValue += p->Cnt;
+    p->Cnt = 0;
   }
 }
 
 /*********************************************************************
 *
-*       _PrintUnsigned
+*       _Flush
+*
+*  Function description
+*    Passes the characters of the current window on to RTT and opens
+*    a new window.
 */
-static void _PrintUnsigned(SEGGER_RTT_PRINTF_DESC * pBufferDesc, unsigned v, unsigned Base, int NumDigits, unsigned FieldWidth, unsigned FormatFlags) {
-  static const char _aV2C[16] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
-  unsigned Div;
-  unsigned Digit = 1;
-  unsigned Number;
-  unsigned Width;
-  char c;
-
-  Number = v;
-
-  //
-  // Get actual field width
-  //
-  Width = 1;
-  while (Number >= Base) {
-    Number = (Number / Base);
-    Width++;
+static void _Flush(SEGGER_RTT_PRINTF_DESC * p) {
+  _Commit(p);
+  if (p->ReturnValue >= 0) {
+    _OpenWindow(p);
   }
-  if ((unsigned)NumDigits > Width) {
-    Width = NumDigits;
+}
+
+/*********************************************************************
+*
+*       _StoreChar
+*/
+static void _StoreChar(SEGGER_RTT_PRINTF_DESC * p, char c) {
+  if (p->Cnt == p->BufferSize) {
+    _Flush(p);
+    if (p->ReturnValue < 0) {
+      return;
+    }
   }
-  //
-  // Print leading chars if necessary
-  //
-  if ((FormatFlags & FORMAT_FLAG_LEFT_JUSTIFY) == 0) {
-    if (FieldWidth != 0) {
-      if (((FormatFlags & FORMAT_FLAG_PAD_ZERO) == FORMAT_FLAG_PAD_ZERO) && (NumDigits == 0)) {
-        c = '0';
-      } else {
-        c = ' ';
-      }
-      while ((FieldWidth != 0) && (Width < FieldWidth--)) {
-        _StoreChar(pBufferDesc, c);
-        if (pBufferDesc->ReturnValue < 0) {
-          return;
-        }
+  p->pBuffer[p->Cnt++] = c;
+}
+
+/*********************************************************************
+*
+*       _StoreRepeat
+*
+*  Function description
+*    Stores NumChars copies of c, e.g. for padding.
+*/
+static void _StoreRepeat(SEGGER_RTT_PRINTF_DESC * p, char c, unsigned NumChars) {
+  unsigned NumBytes;
+  char*    pDest;
+
+  while (NumChars) {
+    if (p->Cnt == p->BufferSize) {
+      _Flush(p);
+      if (p->ReturnValue < 0) {
+        return;
       }
     }
-  }
-  //
-  // Count how many digits are required by precision
-  //
-  while (((v / Digit) >= Base) | (NumDigits-- > 1)) {
-    Digit *= Base;
-  }
-  //
-  // Output digits
-  //
-  do {
-    Div = v / Digit;
-    v -= Div * Digit;
-    _StoreChar(pBufferDesc, _aV2C[Div]);
-    if (pBufferDesc->ReturnValue < 0) {
-      break;
+    NumBytes = p->BufferSize - p->Cnt;
+    if (NumBytes > NumChars) {
+      NumBytes = NumChars;
     }
-    Digit /= Base;
-  } while (Digit);
-  //
-  // Print trailing spaces if necessary
-  //
-  if ((FormatFlags & FORMAT_FLAG_LEFT_JUSTIFY) == FORMAT_FLAG_LEFT_JUSTIFY) {
-    if (FieldWidth != 0) {
-      while ((FieldWidth != 0) && (Width < FieldWidth--)) {
-        _StoreChar(pBufferDesc, ' ');
-        if (pBufferDesc->ReturnValue < 0) {
-          return;
-        }
+    pDest     = p->pBuffer + p->Cnt;
+    p->Cnt   += NumBytes;
+    NumChars -= NumBytes;
+    do {
+      *pDest++ = c;
+    } while (--NumBytes);
+  }
+}
+
+/*********************************************************************
+*
+*       _StoreBlock
+*/
+static void _StoreBlock(SEGGER_RTT_PRINTF_DESC * p, const char * pData, unsigned NumBytes) {
+  unsigned NumBytesAtOnce;
+  char*    pDest;
+
+  while (NumBytes) {
+    if (p->Cnt == p->BufferSize) {
+      _Flush(p);
+      if (p->ReturnValue < 0) {
+        return;
       }
     }
+    NumBytesAtOnce = p->BufferSize - p->Cnt;
+    if (NumBytesAtOnce > NumBytes) {
+      NumBytesAtOnce = NumBytes;
+    }
+    pDest     = p->pBuffer + p->Cnt;
+    p->Cnt   += NumBytesAtOnce;
+    NumBytes -= NumBytesAtOnce;
+    do {
+      *pDest++ = *pData++;
+    } while (--NumBytesAtOnce);
   }
 }
 
 /*********************************************************************
 *
-*       _PrintInt
+*       _StoreString
+*
+*  Function description
+*    Copies a \0 terminated string, or the run of characters up to
+*    the next Delimiter, as a block into the output window.
+*
+*  Return value
+*    Pointer to the character which terminated the copy.
 */
-static void _PrintInt(SEGGER_RTT_PRINTF_DESC * pBufferDesc, int v, unsigned Base, unsigned NumDigits, unsigned FieldWidth, unsigned FormatFlags) {
-  unsigned Width;
-  unsigned Number;
+static const char * _StoreString(SEGGER_RTT_PRINTF_DESC * p, const char * s, char Delimiter) {
+  char* pDest;
+  char* pEnd;
+  char  c;
 
-  Number = (v < 0) ? -v : v;
+  do {
+    pDest = p->pBuffer + p->Cnt;
+    pEnd  = p->pBuffer + p->BufferSize;
+    while (pDest != pEnd) {
+      c = *s;
+      if ((c == 0) || (c == Delimiter)) {
+        p->Cnt = pDest - p->pBuffer;
+        return s;
+      }
+      *pDest++ = c;
+      s++;
+    }
+    p->Cnt = p->BufferSize;
+    _Flush(p);
+  } while (p->ReturnValue >= 0);
+  return s;
+}
 
-  //
-  // Get actual field width
-  //
-  Width = 1;
-  while (Number >= Base) {
-    Number = (Number / Base);
-    Width++;
-  }
-  if (NumDigits > Width) {
-    Width = NumDigits;
-  }
-  if ((FieldWidth > 0) && ((v < 0) || ((FormatFlags & FORMAT_FLAG_PRINT_SIGN) == FORMAT_FLAG_PRINT_SIGN))) {
-    FieldWidth--;
-  }
+/*********************************************************************
+*
+*       _ConvertDigits
+*
+*  Function description
+*    Converts v into digits, most significant digit first,
+*    without using division.
+*
+*  Return value
+*    Number of digits stored in pDigits (at least 1).
+*/
+static unsigned _ConvertDigits(char * pDigits, unsigned v, unsigned Base) {
+  unsigned NumDigits;
+  unsigned Pow;
+  unsigned i;
+  int      Shift;
+  char     c;
 
-  //
-  // Print leading spaces if necessary
-  //
-  if ((((FormatFlags & FORMAT_FLAG_PAD_ZERO) == 0) || (NumDigits != 0)) && ((FormatFlags & FORMAT_FLAG_LEFT_JUSTIFY) == 0)) {
-    if (FieldWidth != 0) {
-      while ((FieldWidth != 0) && (Width < FieldWidth--)) {
-        _StoreChar(pBufferDesc, ' ');
-        if (pBufferDesc->ReturnValue < 0) {
-          return;
-        }
-      }
+  if (Base == 16) {
+    Shift = 28;
+    while ((Shift > 0) && ((v >> Shift) == 0)) {
+      Shift -= 4;
     }
+    NumDigits = 0;
+    do {
+      pDigits[NumDigits++] = _aV2C[(v >> Shift) & 0xF];
+      Shift -= 4;
+    } while (Shift >= 0);
+    return NumDigits;
   }
-  //
-  // Print sign if necessary
-  //
-  if (v < 0) {
-    v = -v;
-    _StoreChar(pBufferDesc, '-');
-    if (pBufferDesc->ReturnValue < 0) {
-      return;
-    }
-  } else if ((FormatFlags & FORMAT_FLAG_PRINT_SIGN) == FORMAT_FLAG_PRINT_SIGN) {
-    _StoreChar(pBufferDesc, '+');
-    if (pBufferDesc->ReturnValue < 0) {
-      return;
-    }
+  i = 0;
+  while ((i < MAX_NUM_DIGITS - 1) && (v < _aPow10[i])) {
+    i++;
   }
+  NumDigits = 0;
+  do {
+    Pow = _aPow10[i];
+    c   = '0';
+    while (v >= Pow) {
+      v -= Pow;
+      c++;
+    }
+    pDigits[NumDigits++] = c;
+  } while (++i < MAX_NUM_DIGITS);
+  return NumDigits;
+}
+
+/*********************************************************************
+*
+*       _PrintNumber
+*
+*  Function description
+*    Outputs the digits of v with optional sign, precision
+*    (NumDigits) and padding to FieldWidth.
+*/
+static void _PrintNumber(SEGGER_RTT_PRINTF_DESC * pBufferDesc, unsigned v, char Sign, unsigned Base, unsigned NumDigits, unsigned FieldWidth, unsigned FormatFlags) {
+  char     acDigits[MAX_NUM_DIGITS];
+  unsigned NumChars;
+  unsigned NumZeros;
+  unsigned NumPad;
+  unsigned Width;
+
+  NumChars = _ConvertDigits(acDigits, v, Base);
+  NumZeros = (NumDigits > NumChars) ? (NumDigits - NumChars) : 0;
+  Width    = NumChars + NumZeros + ((Sign != 0) ? 1 : 0);
+  NumPad   = (FieldWidth > Width) ? (FieldWidth - Width) : 0;
   //
-  // Print leading zeros if necessary
+  // Print leading spaces if necessary. Zero padding is only used
+  // when neither precision nor left justification is requested.
   //
-  if (((FormatFlags & FORMAT_FLAG_PAD_ZERO) == FORMAT_FLAG_PAD_ZERO) && ((FormatFlags & FORMAT_FLAG_LEFT_JUSTIFY) == 0) && (NumDigits == 0)) {
-    if (FieldWidth != 0) {
-      while ((FieldWidth != 0) && (Width < FieldWidth--)) {
-        _StoreChar(pBufferDesc, '0');
-        if (pBufferDesc->ReturnValue < 0) {
-          return;
-        }
-      }
+  if ((FormatFlags & FORMAT_FLAG_LEFT_JUSTIFY) == 0) {
+    if (((FormatFlags & FORMAT_FLAG_PAD_ZERO) == FORMAT_FLAG_PAD_ZERO) && (NumDigits == 0)) {
+      NumZeros += NumPad;
+    } else {
+      _StoreRepeat(pBufferDesc, ' ', NumPad);
     }
+    NumPad = 0;
   }
-
+  if (Sign != 0) {
+    _StoreChar(pBufferDesc, Sign);
+  }
+  _StoreRepeat(pBufferDesc, '0', NumZeros);
+  _StoreBlock(pBufferDesc, acDigits, NumChars);
   //
-  // Print number without sign
+  // Print trailing spaces if necessary
   //
-  _PrintUnsigned(pBufferDesc, v, Base, NumDigits, FieldWidth, FormatFlags);
+  _StoreRepeat(pBufferDesc, ' ', NumPad);
 }
 
 /*********************************************************************
@@ -264,6 +375,13 @@ static void _PrintInt(SEGGER_RTT_PRINTF_DESC * pBufferDesc, int v, unsigned Base
 *  Return values
 *    >= 0:  Number of bytes which have been stored in the "Up"-buffer.
 *     < 0:  Error
+*
+*  Notes
+*    (1) Literal text between conversion specifications is copied as
+*        one block. Output is generated directly in the "Up"-buffer
+*        while it has at least SEGGER_RTT_PRINTF_BUFFER_SIZE contiguous
+*        bytes free, otherwise it is staged in a local buffer of that
+*        size and passed to SEGGER_RTT_Write().
 */
 int SEGGER_RTT_vprintf(unsigned BufferIndex, const char * sFormat, va_list * pParamList) {
   char c;
@@ -274,131 +392,118 @@ int SEGGER_RTT_vprintf(unsigned BufferIndex, const char * sFormat, va_list * pPa
   unsigned FieldWidth;
   char acBuffer[SEGGER_RTT_PRINTF_BUFFER_SIZE];
 
-  BufferDesc.pBuffer        = acBuffer;
-  BufferDesc.BufferSize     = SEGGER_RTT_PRINTF_BUFFER_SIZE;
+  BufferDesc.pStage         = acBuffer;
   BufferDesc.Cnt            = 0;
   BufferDesc.RTTBufferIndex = BufferIndex;
   BufferDesc.ReturnValue    = 0;
+  _OpenWindow(&BufferDesc);
 
   do {
+    sFormat = _StoreString(&BufferDesc, sFormat, '%');
+    if (BufferDesc.ReturnValue < 0) {
+      break;
+    }
     c = *sFormat++;
     if (c == 0) {
       break;
     }
-    if (c == '%') {
-      //
-      // Filter out flags
-      //
-      FormatFlags = 0;
-      do {
-        c = *sFormat;
-        switch (c) {
-        case '-': FormatFlags |= FORMAT_FLAG_LEFT_JUSTIFY; sFormat++; break;
-        case '0': FormatFlags |= FORMAT_FLAG_PAD_ZERO;     sFormat++; break;
-        case '+': FormatFlags |= FORMAT_FLAG_PRINT_SIGN;   sFormat++; break;
-        case '#': FormatFlags |= FORMAT_FLAG_ALTERNATE;    sFormat++; break;
-        default:  goto FilterFieldWidth;                   break;
-        }
-      } while (1);
-      //
-      // filter out field with
-      //
+    //
+    // Filter out flags
+    //
+    FormatFlags = 0;
+    do {
+      c = *sFormat;
+      switch (c) {
+      case '-': FormatFlags |= FORMAT_FLAG_LEFT_JUSTIFY; sFormat++; break;
+      case '0': FormatFlags |= FORMAT_FLAG_PAD_ZERO;     sFormat++; break;
+      case '+': FormatFlags |= FORMAT_FLAG_PRINT_SIGN;   sFormat++; break;
+      case '#': FormatFlags |= FORMAT_FLAG_ALTERNATE;    sFormat++; break;
+      default:  goto FilterFieldWidth;                   break;
+      }
+    } while (1);
+    //
+    // filter out field with
+    //
 FilterFieldWidth:
-      FieldWidth = 0;
+    FieldWidth = 0;
+    do {
+      c = *sFormat;
+      if (c < '0' || c > '9') {
+        break;
+      }
+      sFormat++;
+      FieldWidth = FieldWidth * 10 + (c - '0');
+    } while (1);
+
+    //
+    // Filter out precision (number of digits to display)
+    //
+    NumDigits = 0;
+    c = *sFormat;
+    if (c == '.') {
+      sFormat++;
       do {
         c = *sFormat;
         if (c < '0' || c > '9') {
           break;
         }
         sFormat++;
-        FieldWidth = FieldWidth * 10 + (c - '0');
-      } while (1);
-
-      //
-      // Filter out precision (number of digits to display)
-      //
-      NumDigits = 0;
-      c = *sFormat;
-      if (c == '.') {
-        sFormat++;
-        do {
-          c = *sFormat;
-          if (c < '0' || c > '9') {
-            break;
-          }
-          sFormat++;
-          NumDigits = NumDigits * 10 + (c - '0');
-        } while (1);
-      }
-      //
-      // Filter out length modifier
-      //
-      c = *sFormat;
-      do {
-        if (c == 'l' || c == 'h') {
-          c = *sFormat++;
-          continue;
-        }
-        break;
+        NumDigits = NumDigits * 10 + (c - '0');
       } while (1);
-      //
-      // Handle specifiers
-      //
-      switch (c) {
-      case 'c': {
-        char c0;
-        v = va_arg(*pParamList, int);
-        c0 = (char)v;
-        _StoreChar(&BufferDesc, c0);
-        break;
-      }
-      case 'd':
-        v = va_arg(*pParamList, int);
-        _PrintInt(&BufferDesc, v, 10, NumDigits, FieldWidth, FormatFlags);
-        break;
-      case 'u':
-        v = va_arg(*pParamList, int);
-        _PrintUnsigned(&BufferDesc, v, 10, NumDigits, FieldWidth, FormatFlags);
-        break;
-      case 'x':
-      case 'X':
-        v = va_arg(*pParamList, int);
-        _PrintUnsigned(&BufferDesc, v, 16, NumDigits, FieldWidth, FormatFlags);
-        break;
-      case 's':
-        {
-          const char * s = va_arg(*pParamList, const char *);
-          do {
-            c = *s++;
-            if (c == 0) {
-              break;
-            }
-           _StoreChar(&BufferDesc, c);
-          } while (BufferDesc.ReturnValue >= 0);
-        }
-        break;
-      case 'p':
-        v = va_arg(*pParamList, int);
-        _PrintUnsigned(&BufferDesc, v, 16, 8, 8, 0);
-        break;
-      case '%':
-        _StoreChar(&BufferDesc, '%');
-        break;
+    }
+    //
+    // Filter out length modifier
+    //
+    while ((c == 'l') || (c == 'h')) {
+      c = *++sFormat;
+    }
+    //
+    // Handle specifiers
+    //
+    switch (c) {
+    case 'c': {
+      char c0;
+      v = va_arg(*pParamList, int);
+      c0 = (char)v;
+      _StoreChar(&BufferDesc, c0);
+      break;
+    }
+    case 'd':
+      v = va_arg(*pParamList, int);
+      if (v < 0) {
+        _PrintNumber(&BufferDesc, 0u - (unsigned)v, '-', 10, NumDigits, FieldWidth, FormatFlags);
+      } else {
+        _PrintNumber(&BufferDesc, (unsigned)v, ((FormatFlags & FORMAT_FLAG_PRINT_SIGN) == FORMAT_FLAG_PRINT_SIGN) ? '+' : 0, 10, NumDigits, FieldWidth, FormatFlags);
       }
-      sFormat++;
-    } else {
-      _StoreChar(&BufferDesc, c);
+      break;
+    case 'u':
+      _PrintNumber(&BufferDesc, va_arg(*pParamList, unsigned), 0, 10, NumDigits, FieldWidth, FormatFlags);
+      break;
+    case 'x':
+    case 'X':
+      _PrintNumber(&BufferDesc, va_arg(*pParamList, unsigned), 0, 16, NumDigits, FieldWidth, FormatFlags);
+      break;
+    case 's':
+      _StoreString(&BufferDesc, va_arg(*pParamList, const char *), 0);
+      break;
+    case 'p':
+      _PrintNumber(&BufferDesc, (unsigned)(size_t)va_arg(*pParamList, void *), 0, 16, 8, 8, 0);
+      break;
+    case '%':
+      _StoreChar(&BufferDesc, '%');
+      break;
+    case 0:
+      sFormat--;                                                       // Incomplete specification at end of format string
+      break;
     }
+    sFormat++;
   } while (BufferDesc.ReturnValue >= 0);
 
-  if (BufferDesc.ReturnValue > 0) {
+  if (BufferDesc.ReturnValue >= 0) {
     //
     // Write remaining data, if any
     //
-    if (BufferDesc.Cnt != 0) {
-      SEGGER_RTT_Write(BufferIndex, acBuffer, BufferDesc.Cnt);
-    }
-    BufferDesc.ReturnValue += BufferDesc.Cnt;
+    _Commit(&BufferDesc);
   }
   return BufferDesc.ReturnValue;
 }
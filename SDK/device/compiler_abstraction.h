@@ -50,6 +50,24 @@
         #define __ALIGN(n)          __align(n)                  
     #endif
     
+    #ifndef __NOINIT
+        #define __NOINIT            __attribute__((section(".noinit"), zero_init)) 
+    #endif
+    
+    /* Needs a scatter file which places .ramfunc in RAM. */
+    #ifndef __RAMFUNC
+        #define __RAMFUNC           __attribute__((section(".ramfunc"))) 
+    #endif
+    
+    /* armlink adds veneers for calls out of range. */
+    #ifndef __LONG_CALL
+        #define __LONG_CALL                                     
+    #endif
+    
+    #ifndef __USED
+        #define __USED              __attribute__((used))       
+    #endif
+    
     #define GET_SP()                __current_sp()              
   
 #elif defined ( __ICCARM__ )
@@ -71,6 +89,23 @@
         #define __ALIGN(n)          
     #endif
     
+    #ifndef __NOINIT
+        #define __NOINIT            __no_init                   
+    #endif
+    
+    #ifndef __RAMFUNC
+        #define __RAMFUNC           __ramfunc                   
+    #endif
+    
+    /* ILINK adds veneers for calls out of range. */
+    #ifndef __LONG_CALL
+        #define __LONG_CALL                                     
+    #endif
+    
+    #ifndef __USED
+        #define __USED              __root                      
+    #endif
+    
     #define GET_SP()                __get_SP()                  
     
 #elif defined   ( __GNUC__ )
@@ -91,6 +126,29 @@
         #define __ALIGN(n)          __attribute__((aligned(n))) 
     #endif
     
+    #ifndef __NOINIT
+        #define __NOINIT            __attribute__((section(".noinit"))) 
+    #endif
+    
+    /* Copied to RAM by the startup code, see .ramfunc in nrf51_common.ld. Calls
+     * between flash and RAM are out of reach of BL. long_call only reaches callers
+     * which see the attribute, so prototypes of RAM functions carry __RAMFUNC too,
+     * and prototypes of flash functions called from RAM carry __LONG_CALL. Other
+     * calls across, e.g. to a static inline function the compiler did not inline,
+     * go through a long-branch stub which ld places next to the caller. */
+    #ifndef __RAMFUNC
+        #define __RAMFUNC           __attribute__((section(".ramfunc"), long_call)) 
+    #endif
+    
+    #ifndef __LONG_CALL
+        #define __LONG_CALL         __attribute__((long_call))  
+    #endif
+    
+    /* Kept by the compiler and by -flto although only assembly refers to it. */
+    #ifndef __USED
+        #define __USED              __attribute__((used))       
+    #endif
+    
     #define GET_SP()                gcc_current_sp()            
 
     static inline unsigned int gcc_current_sp(void)
@@ -117,6 +175,23 @@
         #define __ALIGN(n)          __align(n)                  
     #endif
     
+    #ifndef __NOINIT
+        #define __NOINIT            __attribute__((section(".noinit"))) 
+    #endif
+    
+    /* Runs from flash. */
+    #ifndef __RAMFUNC
+        #define __RAMFUNC                                      
+    #endif
+    
+    #ifndef __LONG_CALL
+        #define __LONG_CALL                                    
+    #endif
+    
+    #ifndef __USED
+        #define __USED              __attribute__((used))      
+    #endif
+    
     #define GET_SP()                __get_MSP()                
     
 #endif
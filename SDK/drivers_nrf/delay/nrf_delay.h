@@ -237,6 +237,16 @@ __ASM volatile (
 }
 #endif
 
+/**
+ * @brief Function for delaying execution for number of milliseconds.
+ *
+ * @note This stays a cycle loop with the CPU at full power: it does not use RTC1, even with
+ *       the application timer running, since drivers do not depend on app_timer. Callers which
+ *       can use the application timer should call app_timer_delay_us(), which sleeps through
+ *       longer delays and does not depend on the CPU clock.
+ *
+ * @param number_of_ms
+ */
 void nrf_delay_ms(uint32_t volatile number_of_ms);
 
 #endif
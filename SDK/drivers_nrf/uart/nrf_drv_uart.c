@@ -16,6 +16,7 @@
 #include "nrf_drv_common.h"
 #include "nrf_gpio.h"
 #include "app_util_platform.h"
+#include "app_irq_prof.h"
 
 // This set of macros makes it possible to exclude parts of code, when one type
 // of supported peripherals is not used.
@@ -564,8 +565,11 @@ void nrf_drv_uart_rx_abort(void)
     )
 }
 
-void UART0_IRQHandler(void)
+// Runs from RAM with the per-byte path of app_uart_fifo, see __RAMFUNC.
+__RAMFUNC void UART0_IRQHandler(void)
 {
+    APP_IRQ_PROF_ENTER(UART0_IRQn);
+
     CODE_FOR_UARTE
     (
         if (nrf_uarte_event_check(NRF_UARTE0, NRF_UARTE_EVENT_ERROR))
@@ -680,4 +684,6 @@ void UART0_IRQHandler(void)
             }
         }
     )
+
+    APP_IRQ_PROF_EXIT();
 }
@@ -183,8 +183,10 @@ __STATIC_INLINE uint32_t nrf_drv_uart_event_address_get(nrf_uart_event_t event);
  * @retval    NRF_ERROR_BUSY         If driver is already transferring.
  * @retval    NRF_ERROR_INVALID_ADDR If p_data does not point to RAM buffer (UARTE only).
  * @retval    NRF_ERROR_FORBIDDEN    If transfer was aborted (blocking mode only).
+ *
+ * @note Called from the app_uart_fifo interrupt path in RAM, hence __LONG_CALL.
  */
-ret_code_t nrf_drv_uart_tx(uint8_t const * const p_data, uint8_t length);
+__LONG_CALL ret_code_t nrf_drv_uart_tx(uint8_t const * const p_data, uint8_t length);
 
 /**
  * @brief Function for aborting any ongoing transmission.
@@ -214,8 +216,10 @@ void nrf_drv_uart_tx_abort(void);
  * @retval    NRF_ERROR_BUSY         If driver is already receiving.
  * @retval    NRF_ERROR_INVALID_ADDR If p_data does not point to RAM buffer (UARTE only).
  * @retval    NRF_ERROR_FORBIDDEN    If transfer was aborted (blocking mode only).
+ *
+ * @note Called from the app_uart_fifo interrupt path in RAM, hence __LONG_CALL.
  */
-ret_code_t nrf_drv_uart_rx(uint8_t * p_data, uint8_t length);
+__LONG_CALL ret_code_t nrf_drv_uart_rx(uint8_t * p_data, uint8_t length);
 
 /**
  * @brief Function for enabling receiver.
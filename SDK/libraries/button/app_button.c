@@ -0,0 +1,312 @@
+/** @file
+ *
+ * @defgroup app_button Buttons
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Debounced buttons with short, long, double and chorded press detection.
+ */
+
+#include "app_button.h"
+#include <stddef.h>
+#include "nrf.h"
+#include "nrf_error.h"
+#include "nrf_gpio.h"
+#include "nrf_drv_common.h"
+#include "app_util_platform.h"
+#include "app_scheduler.h"
+#include "app_timer.h"
+#include "app_irq_prof.h"
+
+STATIC_ASSERT(APP_BUTTON_MAX <= 8);
+
+/**@brief Gesture state of a button. */
+typedef enum
+{
+    GESTURE_IDLE,               /**< Released. */
+    GESTURE_PRESSED,            /**< Pressed, long press timer running. */
+    GESTURE_HELD,               /**< Long press reported, waiting for the release. */
+    GESTURE_WAIT_DOUBLE,        /**< Released after a short press, double press timer running. */
+    GESTURE_SECOND,             /**< Double press reported, waiting for the release. */
+    GESTURE_CHORD               /**< Chord reported, waiting for the release. */
+} gesture_state_t;
+
+APP_TIMER_DEF(m_debounce_timer);                        /**< Single-shot timer restarted on every pin change. */
+static app_timer_t          m_gesture_timers[APP_BUTTON_MAX];   /**< Long and double press timers, one per button. */
+static uint8_t              m_gesture[APP_BUTTON_MAX];  /**< gesture_state_t of each button. */
+static uint8_t              m_pins[APP_BUTTON_MAX];     /**< Pins of the buttons. */
+static uint8_t              m_count;                    /**< Number of buttons. */
+static bool                 m_active_low;               /**< A pressed button reads low. */
+static app_button_handler_t m_handler;                  /**< Application event handler. */
+static uint8_t              m_state;                    /**< Debounced state, bit n set if button n is pressed. */
+
+
+static void evt_sched_handler(void * p_event_data, uint16_t event_size)
+{
+    UNUSED_PARAMETER(event_size);
+
+    m_handler((app_button_evt_t const *)p_event_data);
+}
+
+
+static void evt_send(app_button_evt_type_t type, uint8_t buttons)
+{
+    app_button_evt_t evt;
+
+    evt.type    = (uint8_t)type;
+    evt.buttons = buttons;
+    (void)app_sched_event_put_prio(&evt, sizeof(evt), evt_sched_handler, APP_SCHED_PRIO_HIGH);
+}
+
+
+static void gesture_timer_start(uint8_t button, uint32_t ms)
+{
+    (void)app_timer_start(&m_gesture_timers[button], APP_TIMER_TICKS(ms),
+                          (void *)(uintptr_t)button);
+}
+
+
+static void gesture_timer_stop(uint8_t button)
+{
+    (void)app_timer_stop(&m_gesture_timers[button]);
+}
+
+
+static void gesture_press(uint8_t button)
+{
+    uint8_t chord = 0;
+    uint8_t i;
+
+    // Buttons still waiting for their long press timeout join this one in a chord.
+    for (i = 0; i < m_count; i++)
+    {
+        if ((i != button) && (m_gesture[i] == GESTURE_PRESSED))
+        {
+            chord |= (uint8_t)(1 << i);
+        }
+    }
+    if (chord != 0)
+    {
+        chord |= (uint8_t)(1 << button);
+        for (i = 0; i < m_count; i++)
+        {
+            if ((chord & (1 << i)) != 0)
+            {
+                gesture_timer_stop(i);
+                m_gesture[i] = GESTURE_CHORD;
+            }
+        }
+        evt_send(APP_BUTTON_EVT_CHORD, chord);
+        return;
+    }
+
+    if (m_gesture[button] == GESTURE_WAIT_DOUBLE)
+    {
+        gesture_timer_stop(button);
+        m_gesture[button] = GESTURE_SECOND;
+        evt_send(APP_BUTTON_EVT_DOUBLE, (uint8_t)(1 << button));
+    }
+    else
+    {
+        m_gesture[button] = GESTURE_PRESSED;
+        gesture_timer_start(button, APP_BUTTON_LONG_MS);
+    }
+}
+
+
+static void gesture_release(uint8_t button)
+{
+    if (m_gesture[button] == GESTURE_PRESSED)
+    {
+        gesture_timer_stop(button);
+        if (APP_BUTTON_DOUBLE_MS == 0)
+        {
+            m_gesture[button] = GESTURE_IDLE;
+            evt_send(APP_BUTTON_EVT_SHORT, (uint8_t)(1 << button));
+        }
+        else
+        {
+            m_gesture[button] = GESTURE_WAIT_DOUBLE;
+            gesture_timer_start(button, APP_BUTTON_DOUBLE_MS);
+        }
+    }
+    else
+    {
+        m_gesture[button] = GESTURE_IDLE;
+    }
+}
+
+
+static void gesture_timeout_handler(void * p_context)
+{
+    uint8_t button = (uint8_t)(uintptr_t)p_context;
+
+    if (m_gesture[button] == GESTURE_PRESSED)
+    {
+        m_gesture[button] = GESTURE_HELD;
+        evt_send(APP_BUTTON_EVT_LONG, (uint8_t)(1 << button));
+    }
+    else if (m_gesture[button] == GESTURE_WAIT_DOUBLE)
+    {
+        m_gesture[button] = GESTURE_IDLE;
+        evt_send(APP_BUTTON_EVT_SHORT, (uint8_t)(1 << button));
+    }
+}
+
+
+/**@brief Function for making every pin sense the level opposite to its current one.
+ *
+ * @details DETECT then goes low, and the next change raises a new PORT event. A pin which
+ *          changes while this runs might not raise DETECT again, so the pins are read once more.
+ *
+ * @param[out] p_in  Pin levels the senses were set from.
+ *
+ * @retval true   If the pins did not change meanwhile.
+ * @retval false  If a pin changed; the caller must look again later.
+ */
+static bool sense_update(uint32_t * p_in)
+{
+    uint32_t in   = NRF_GPIO->IN;
+    uint32_t mask = 0;
+    uint8_t  i;
+
+    for (i = 0; i < m_count; i++)
+    {
+        nrf_gpio_cfg_sense_set(m_pins[i], ((in >> m_pins[i]) & 1) ?
+                                          NRF_GPIO_PIN_SENSE_LOW : NRF_GPIO_PIN_SENSE_HIGH);
+        mask |= 1UL << m_pins[i];
+    }
+    NRF_GPIOTE->EVENTS_PORT = 0;
+
+    *p_in = in;
+    return ((NRF_GPIO->IN ^ in) & mask) == 0;
+}
+
+
+static void debounce_timer_start(void)
+{
+    (void)app_timer_start(m_debounce_timer, APP_TIMER_TICKS(APP_BUTTON_DEBOUNCE_MS), NULL);
+}
+
+
+/**@brief Function for accepting the pin levels once they have been stable, from RTC1. */
+static void debounce_timeout_handler(void * p_context)
+{
+    uint32_t in;
+    uint8_t  pressed = 0;
+    uint8_t  changed;
+    uint8_t  i;
+
+    UNUSED_PARAMETER(p_context);
+
+    if (!sense_update(&in))
+    {
+        debounce_timer_start();
+        return;
+    }
+
+    for (i = 0; i < m_count; i++)
+    {
+        if ((((in >> m_pins[i]) & 1) == 0) == m_active_low)
+        {
+            pressed |= (uint8_t)(1 << i);
+        }
+    }
+
+    changed = pressed ^ m_state;
+    m_state = pressed;
+    for (i = 0; i < m_count; i++)
+    {
+        if ((changed & (1 << i)) != 0)
+        {
+            if ((pressed & (1 << i)) != 0)
+            {
+                gesture_press(i);
+            }
+            else
+            {
+                gesture_release(i);
+            }
+        }
+    }
+}
+
+
+uint32_t app_button_init(uint8_t const *      p_pins,
+                         uint8_t              count,
+                         bool                 active_low,
+                         app_button_handler_t handler)
+{
+    uint32_t       err_code;
+    uint32_t       in;
+    app_timer_id_t timer_id;
+    uint8_t        i;
+
+    if ((count == 0) || (count > APP_BUTTON_MAX) || (handler == NULL))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    m_count      = count;
+    m_active_low = active_low;
+    m_handler    = handler;
+    m_state      = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        m_pins[i]    = p_pins[i];
+        m_gesture[i] = GESTURE_IDLE;
+        nrf_gpio_cfg_sense_input(m_pins[i],
+                                 active_low ? NRF_GPIO_PIN_PULLUP : NRF_GPIO_PIN_PULLDOWN,
+                                 NRF_GPIO_PIN_NOSENSE);
+
+        timer_id = &m_gesture_timers[i];
+        err_code = app_timer_create(&timer_id, APP_TIMER_MODE_SINGLE_SHOT, gesture_timeout_handler);
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+    }
+
+    err_code = app_timer_create(&m_debounce_timer, APP_TIMER_MODE_SINGLE_SHOT,
+                                debounce_timeout_handler);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    (void)sense_update(&in);
+    NRF_GPIOTE->INTENSET = GPIOTE_INTENSET_PORT_Msk;
+    nrf_drv_common_irq_enable(GPIOTE_IRQn, APP_IRQ_PRIORITY_LOW);
+
+    // A button held already, such as the one which woke the chip, is picked up here.
+    debounce_timer_start();
+
+    return NRF_SUCCESS;
+}
+
+
+uint8_t app_button_state_get(void)
+{
+    return m_state;
+}
+
+
+/**@brief GPIOTE interrupt handler, restarting the debounce timer on every pin change.
+ */
+void GPIOTE_IRQHandler(void)
+{
+    uint32_t in;
+
+    APP_IRQ_PROF_ENTER(GPIOTE_IRQn);
+
+    if (NRF_GPIOTE->EVENTS_PORT != 0)
+    {
+        (void)sense_update(&in);
+        debounce_timer_start();
+    }
+
+    APP_IRQ_PROF_EXIT();
+}
+
+/** @} */
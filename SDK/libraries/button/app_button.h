@@ -0,0 +1,99 @@
+/** @file
+ *
+ * @defgroup app_button Buttons
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Debounced buttons with short, long, double and chorded press detection.
+ *
+ * @details The button pins are watched with the GPIOTE PORT event: each pin senses the level
+ *          opposite to its current one, which costs no current while nothing happens, unlike
+ *          GPIOTE IN channels. A PORT event (re)starts a debounce timer on RTC1 (see
+ *          @ref app_timer); when it expires, the pins are read and the changes are fed to a
+ *          gesture state machine per button, timed with one more timer per button:
+ *          - SHORT: pressed and released, and not pressed again within APP_BUTTON_DOUBLE_MS.
+ *          - DOUBLE: pressed again within APP_BUTTON_DOUBLE_MS of a short press.
+ *          - LONG: held for APP_BUTTON_LONG_MS; reported while the button is still held.
+ *          - CHORD: pressed while other buttons are held which have not been reported yet;
+ *            the event carries all of them, and they report nothing else until released.
+ *
+ *          Events reach the application handler through the scheduler, in thread mode, at
+ *          APP_SCHED_PRIO_HIGH. No timer runs while all buttons are released and idle, so
+ *          the power manager can still enter System OFF.
+ *
+ *          A button held when @ref app_button_init is called, e.g. the press which woke the chip
+ *          from System OFF, is reported as pressed then.
+ *
+ * @note    GPIOTE_IRQHandler is owned by this module. The GPIOTE channels are left to other
+ *          modules, see @ref app_led.
+ */
+
+#ifndef APP_BUTTON_H__
+#define APP_BUTTON_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef APP_BUTTON_MAX
+#define APP_BUTTON_MAX          4       /**< Largest number of buttons. Each takes an application timer while in use. */
+#endif
+
+#ifndef APP_BUTTON_DEBOUNCE_MS
+#define APP_BUTTON_DEBOUNCE_MS  20      /**< Time the pins must be stable before a change is accepted. */
+#endif
+
+#ifndef APP_BUTTON_LONG_MS
+#define APP_BUTTON_LONG_MS      800     /**< Hold time of a long press. */
+#endif
+
+#ifndef APP_BUTTON_DOUBLE_MS
+#define APP_BUTTON_DOUBLE_MS    300     /**< Time after a release in which a second press makes a double press, 0 to report short presses at once. */
+#endif
+
+/**@brief Button event types. */
+typedef enum
+{
+    APP_BUTTON_EVT_SHORT,       /**< Short press. */
+    APP_BUTTON_EVT_LONG,        /**< Long press; the button is still held. */
+    APP_BUTTON_EVT_DOUBLE,      /**< Double press. */
+    APP_BUTTON_EVT_CHORD        /**< Several buttons pressed together. */
+} app_button_evt_type_t;
+
+/**@brief Button event. */
+typedef struct
+{
+    uint8_t type;               /**< app_button_evt_type_t. */
+    uint8_t buttons;            /**< Bit n set for button n; several bits for a chord. */
+} app_button_evt_t;
+
+/**@brief Button event handler, called in thread mode. */
+typedef void (*app_button_handler_t)(app_button_evt_t const * p_evt);
+
+/**@brief Function for initializing the buttons and enabling the GPIOTE interrupt.
+ *
+ * @details The pins are configured as inputs. The scheduler and the timer module must be
+ *          initialized first.
+ *
+ * @param[in] p_pins      Pins of the buttons; button n is p_pins[n].
+ * @param[in] count       Number of buttons, at most APP_BUTTON_MAX.
+ * @param[in] active_low  The buttons pull their pin low when pressed, against a pull-up.
+ * @param[in] handler     Event handler.
+ *
+ * @retval NRF_SUCCESS              If the buttons were initialized.
+ * @retval NRF_ERROR_INVALID_PARAM  If count is out of range or handler is NULL.
+ * @return Otherwise, the error returned by app_timer_create().
+ */
+uint32_t app_button_init(uint8_t const *      p_pins,
+                         uint8_t              count,
+                         bool                 active_low,
+                         app_button_handler_t handler);
+
+/**@brief Function for getting the debounced state of the buttons.
+ *
+ * @return Bit n set if button n is pressed.
+ */
+uint8_t app_button_state_get(void);
+
+#endif // APP_BUTTON_H__
+
+/** @} */
@@ -0,0 +1,184 @@
+/** @file
+ *
+ * @defgroup crash_log Crash-surviving log buffer
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Mirror of the most recent log output kept in RAM across resets.
+ */
+
+#include "crash_log.h"
+#include <stdbool.h>
+#include <string.h>
+#include "nrf.h"
+#include "nrf_error.h"
+#include "app_util.h"
+#include "compiler_abstraction.h"
+
+#define CRASH_LOG_MAGIC         0xC0DEB10CUL    /**< Marks a header written by this module. */
+#define CRASH_LOG_STATE_OPEN    0x4F50454EUL    /**< Log is being written ("OPEN"). */
+#define CRASH_LOG_STATE_SEALED  0x5345414CUL    /**< Log was sealed before a reset ("SEAL"). */
+
+#define CRASH_LOG_MASK          (CRASH_LOG_SIZE - 1)
+
+STATIC_ASSERT((CRASH_LOG_SIZE & CRASH_LOG_MASK) == 0);
+
+/**@brief Layout of the preserved log. */
+typedef struct
+{
+    uint32_t magic;                 /**< CRASH_LOG_MAGIC when the header is valid. */
+    uint32_t state;                 /**< CRASH_LOG_STATE_OPEN or CRASH_LOG_STATE_SEALED. */
+    uint32_t write_pos;             /**< Free-running count of bytes written. */
+    uint32_t check;                 /**< Bitwise inverse of write_pos, kept in step with it. */
+    uint32_t crc;                   /**< CRC-16/CCITT of write_pos and data, valid when sealed. */
+    char     data[CRASH_LOG_SIZE];  /**< Log ring. */
+} crash_log_t;
+
+static __NOINIT crash_log_t m_log;  /**< Survives resets; not touched by the startup code. */
+static bool                 m_active; /**< Zeroed at startup, so writes before init are dropped. */
+
+/**@brief Function for updating a CRC-16/CCITT (polynomial 0x1021) over a block, four bits at a time.
+ */
+static uint16_t crc16_update(uint16_t crc, uint8_t const * p_data, uint32_t length)
+{
+    static const uint16_t table[16] =
+    {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+    };
+
+    while (length--)
+    {
+        crc = (uint16_t)((crc << 4) ^ table[(crc >> 12) ^ (*p_data >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ table[(crc >> 12) ^ (*p_data & 0x0F)]);
+        p_data++;
+    }
+    return crc;
+}
+
+
+/**@brief Function for computing the CRC that seals the log.
+ */
+static uint32_t crash_log_crc(void)
+{
+    uint16_t crc = 0xFFFF;
+
+    crc = crc16_update(crc, (uint8_t const *)&m_log.write_pos, sizeof(m_log.write_pos));
+    crc = crc16_update(crc, (uint8_t const *)m_log.data, sizeof(m_log.data));
+    return crc;
+}
+
+
+/**@brief Function for checking whether the log header survived the reset intact.
+ */
+static bool crash_log_is_valid(void)
+{
+    // A power-on or brown-out reset leaves RESETREAS empty; RAM content is undefined then.
+    if (NRF_POWER->RESETREAS == 0)
+    {
+        return false;
+    }
+    if ((m_log.magic != CRASH_LOG_MAGIC) || (m_log.check != ~m_log.write_pos))
+    {
+        return false;
+    }
+    if (m_log.state == CRASH_LOG_STATE_SEALED)
+    {
+        return (m_log.crc == crash_log_crc());
+    }
+    return (m_log.state == CRASH_LOG_STATE_OPEN);
+}
+
+
+uint32_t crash_log_init(crash_log_handler_t replay)
+{
+    uint32_t err_code = NRF_ERROR_NOT_FOUND;
+
+    m_active = false;
+
+    if (crash_log_is_valid() && (m_log.write_pos != 0))
+    {
+        err_code = (m_log.state == CRASH_LOG_STATE_SEALED) ? NRF_SUCCESS : NRF_ERROR_INVALID_STATE;
+
+        if (replay != NULL)
+        {
+            uint32_t pos = m_log.write_pos & CRASH_LOG_MASK;
+
+            if (m_log.write_pos > CRASH_LOG_SIZE)
+            {
+                // The ring has wrapped: the oldest byte is at the write position.
+                replay(&m_log.data[pos], CRASH_LOG_SIZE - pos);
+                if (pos != 0)
+                {
+                    replay(m_log.data, pos);
+                }
+            }
+            else
+            {
+                replay(m_log.data, m_log.write_pos);
+            }
+        }
+    }
+
+    m_log.magic     = CRASH_LOG_MAGIC;
+    m_log.state     = CRASH_LOG_STATE_OPEN;
+    m_log.write_pos = 0;
+    m_log.check     = ~(uint32_t)0;
+    m_log.crc       = 0;
+
+    m_active = true;
+
+    return err_code;
+}
+
+
+void crash_log_write(char const * p_data, uint32_t length)
+{
+    uint32_t write_pos;
+    uint32_t pos;
+
+    if (!m_active)
+    {
+        return;
+    }
+
+    // Only the tail of an oversized block can survive anyway.
+    if (length > CRASH_LOG_SIZE)
+    {
+        p_data += length - CRASH_LOG_SIZE;
+        length  = CRASH_LOG_SIZE;
+    }
+
+    write_pos = m_log.write_pos;
+    pos       = write_pos & CRASH_LOG_MASK;
+
+    if (pos + length > CRASH_LOG_SIZE)
+    {
+        uint32_t chunk = CRASH_LOG_SIZE - pos;
+
+        memcpy(&m_log.data[pos], p_data, chunk);
+        memcpy(m_log.data, p_data + chunk, length - chunk);
+    }
+    else
+    {
+        memcpy(&m_log.data[pos], p_data, length);
+    }
+
+    write_pos      += length;
+    m_log.write_pos = write_pos;
+    m_log.check     = ~write_pos;
+}
+
+
+void crash_log_seal(void)
+{
+    if (!m_active)
+    {
+        return;
+    }
+    m_active    = false;
+    m_log.crc   = crash_log_crc();
+    m_log.state = CRASH_LOG_STATE_SEALED;
+}
+
+/** @} */
@@ -0,0 +1,76 @@
+/** @file
+ *
+ * @defgroup crash_log Crash-surviving log buffer
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Mirror of the most recent log output kept in RAM across resets.
+ *
+ * @details The log ring lives in the .noinit section, which is neither copied nor zeroed by
+ *          the startup code. Every byte written to RTT up-buffer 0 is mirrored into the ring
+ *          (see SEGGER_RTT_MIRROR in SEGGER_RTT_Conf.h), so after a reset caused by
+ *          @ref app_error_handler, the watchdog or a lockup, the last @ref CRASH_LOG_SIZE bytes
+ *          of output can be replayed on the next boot. Writing to the ring is a plain RAM copy;
+ *          no flash is ever touched.
+ *
+ *          The ring is accepted on boot only if its header is consistent and the chip was not
+ *          powered up from cold. If the log was sealed by @ref crash_log_seal, its CRC is
+ *          verified as well.
+ */
+
+#ifndef CRASH_LOG_H__
+#define CRASH_LOG_H__
+
+#include <stdint.h>
+
+#ifndef CRASH_LOG_SIZE
+#define CRASH_LOG_SIZE 512  /**< Number of log bytes kept across a reset. Must be a power of two. */
+#endif
+
+/**@brief Crash log replay handler type.
+ *
+ * @details Called once or twice (when the ring has wrapped) with the preserved bytes in the
+ *          order they were written.
+ *
+ * @param[in] p_data  Preserved log bytes.
+ * @param[in] length  Number of bytes in p_data.
+ */
+typedef void (*crash_log_handler_t)(char const * p_data, uint32_t length);
+
+/**@brief Function for initializing the crash log.
+ *
+ * @details Validates the log left over from before the reset, passes it to the replay handler
+ *          and then starts a new, empty log. Must be called once at startup, before anything
+ *          is logged and before the SoftDevice is enabled (the reset reason is read directly
+ *          from the POWER peripheral). Output produced by the replay handler is not mirrored.
+ *
+ * @param[in] replay  Handler receiving the preserved log. Can be NULL to discard it.
+ *
+ * @retval NRF_SUCCESS              If a sealed log with a valid CRC was replayed.
+ * @retval NRF_ERROR_INVALID_STATE  If an unsealed log (reset without going through
+ *                                  @ref crash_log_seal, e.g. by the watchdog) was replayed.
+ * @retval NRF_ERROR_NOT_FOUND      If there was no valid log to replay.
+ */
+uint32_t crash_log_init(crash_log_handler_t replay);
+
+/**@brief Function for appending bytes to the crash log.
+ *
+ * @details Overwrites the oldest bytes once the ring is full. Calls made before
+ *          @ref crash_log_init are ignored. The function is not reentrant; callers must
+ *          serialize access (the RTT mirror hook runs under SEGGER_RTT_LOCK).
+ *
+ * @param[in] p_data  Bytes to append.
+ * @param[in] length  Number of bytes to append.
+ */
+void crash_log_write(char const * p_data, uint32_t length);
+
+/**@brief Function for sealing the crash log before an intentional reset.
+ *
+ * @details Computes a CRC over the ring so that the next boot can verify its contents.
+ *          No further bytes are accepted until the next @ref crash_log_init.
+ */
+void crash_log_seal(void);
+
+#endif // CRASH_LOG_H__
+
+/** @} */
@@ -0,0 +1,57 @@
+/** @file
+ *
+ * @defgroup app_crit_prof Critical region profiler
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Time spent in each CRITICAL_REGION_ENTER() / CRITICAL_REGION_EXIT() pair.
+ */
+
+#include "app_crit_prof.h"
+#include <stddef.h>
+#include "app_util_platform.h"
+
+static app_crit_prof_site_t * volatile m_p_sites;  /**< Listed sites, most recently listed first. */
+
+
+void app_crit_prof_record(app_crit_prof_site_t * p_site, uint16_t start)
+{
+    uint16_t elapsed = app_timestamp_elapsed(start);
+
+    if (!p_site->listed)
+    {
+        p_site->listed = 1;
+        p_site->p_next = m_p_sites;
+        m_p_sites      = p_site;
+    }
+
+    p_site->count++;
+    p_site->total += elapsed;
+    if (elapsed > p_site->max)
+    {
+        p_site->max = elapsed;
+    }
+}
+
+
+app_crit_prof_site_t const * app_crit_prof_sites_get(void)
+{
+    return m_p_sites;
+}
+
+
+void app_crit_prof_reset(void)
+{
+    app_crit_prof_site_t * p_site;
+
+    CRITICAL_REGION_ENTER();
+    for (p_site = m_p_sites; p_site != NULL; p_site = p_site->p_next)
+    {
+        p_site->max   = 0;
+        p_site->count = 0;
+        p_site->total = 0;
+    }
+    CRITICAL_REGION_EXIT();
+}
+
+/** @} */
@@ -0,0 +1,72 @@
+/** @file
+ *
+ * @defgroup app_crit_prof Critical region profiler
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Time spent in each CRITICAL_REGION_ENTER() / CRITICAL_REGION_EXIT() pair.
+ *
+ * @details In builds with APP_CRIT_PROFILE defined, the critical region macros in
+ *          app_util_platform.h take an @ref app_timestamp when the region has been entered and
+ *          another just before it is left. Each call site has a static @ref app_crit_prof_site_t,
+ *          keyed by the __FILE__ and __LINE__ of its CRITICAL_REGION_ENTER(), which counts the
+ *          regions and keeps their longest and total duration. A site joins the list returned by
+ *          @ref app_crit_prof_sites_get the first time its region is left.
+ *
+ *          Recording runs inside the region, so it needs no locking of its own; it adds a few
+ *          microseconds to the time interrupts stay masked, which the durations do not include.
+ *          Durations are in microseconds and are valid up to 65 ms.
+ *
+ * @note    @ref app_timestamp_init must be called first; regions before it count as 0 us.
+ */
+
+#ifndef APP_CRIT_PROF_H__
+#define APP_CRIT_PROF_H__
+
+#include <stdint.h>
+#include "app_timestamp.h"
+
+/**@brief Statistics of one critical region call site. */
+typedef struct app_crit_prof_site_s
+{
+    char const *                  p_file;   /**< __FILE__ of the CRITICAL_REGION_ENTER(). */
+    uint16_t                      line;     /**< __LINE__ of the CRITICAL_REGION_ENTER(). */
+    uint16_t                      max;      /**< Longest region, in us. */
+    uint32_t                      count;    /**< Regions left. */
+    uint32_t                      total;    /**< Sum of the durations, in us. */
+    struct app_crit_prof_site_s * p_next;   /**< Next site in the list. */
+    uint8_t                       listed;   /**< The site is in the list. */
+} app_crit_prof_site_t;
+
+#ifdef APP_CRIT_PROFILE
+
+/**@brief Declares the site and takes the entry timestamp; used by CRITICAL_REGION_ENTER(). */
+#define APP_CRIT_PROF_ENTER()                                                               \
+        static app_crit_prof_site_t CRIT_PROF_SITE = {__FILE__, __LINE__, 0, 0, 0, 0, 0};   \
+        uint16_t CRIT_PROF_START = app_timestamp_get();
+
+/**@brief Records the region; used by CRITICAL_REGION_EXIT(). */
+#define APP_CRIT_PROF_EXIT()                                                                \
+        app_crit_prof_record(&CRIT_PROF_SITE, CRIT_PROF_START);
+
+#endif
+
+/**@brief Function for recording a region which is about to be left.
+ *
+ * @param[in] p_site  Call site of the region.
+ * @param[in] start   Timestamp taken when the region was entered.
+ */
+void app_crit_prof_record(app_crit_prof_site_t * p_site, uint16_t start);
+
+/**@brief Function for getting the sites which have recorded a region.
+ *
+ * @return First site, most recently listed first, or NULL. Follow p_next for the others.
+ */
+app_crit_prof_site_t const * app_crit_prof_sites_get(void);
+
+/**@brief Function for clearing the statistics of every listed site. */
+void app_crit_prof_reset(void);
+
+#endif // APP_CRIT_PROF_H__
+
+/** @} */
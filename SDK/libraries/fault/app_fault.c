@@ -0,0 +1,168 @@
+/** @file
+ *
+ * @defgroup app_fault Fault capture
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Post-mortem dump of the last error or HardFault, kept in RAM across the reset.
+ */
+
+#include "app_fault.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "nrf.h"
+#include "nrf_error.h"
+#include "nordic_common.h"
+#include "app_util.h"
+#include "compiler_abstraction.h"
+#ifdef CRASH_LOG_ENABLED
+#include "crash_log.h"
+#endif
+
+#define APP_FAULT_MAGIC         0xFA17D0C5UL    /**< Marks a dump which has not been read yet. */
+#define APP_FAULT_MAGIC_READ    0xFA17D0C4UL    /**< Marks a dump picked up on a later boot. */
+#define RAM_START               0x20000000UL    /**< Start of RAM. */
+
+extern uint32_t __StackTop;                     /**< End of RAM, from the linker script. */
+
+static __NOINIT app_fault_dump_t m_dump;        /**< Survives resets; not touched by the startup code. */
+static bool                      m_dump_found;  /**< A dump was picked up by app_fault_init(). */
+
+// Only HardFault_Handler's assembly calls it, which link-time optimization cannot see.
+__USED void app_fault_hardfault_record(app_fault_frame_t const * p_frame, uint32_t exc_return);
+
+
+/**@brief Function for computing the check word over the dump, up to reset_reason. */
+static uint32_t dump_check(void)
+{
+    uint32_t const * p_word = (uint32_t const *)&m_dump;
+    uint32_t         sum    = 0;
+    uint32_t         i;
+
+    for (i = 0; i < offsetof(app_fault_dump_t, reset_reason) / sizeof(uint32_t); i++)
+    {
+        sum += p_word[i];
+    }
+    return ~sum;
+}
+
+
+/**@brief Function for copying the stack from sp up to the end of RAM, sealing the dump and
+ *        resetting the chip.
+ *
+ * @details A stack pointer outside RAM is recorded but not followed, so that a corrupted one
+ *          does not fault again while the dump is written.
+ */
+static void dump_finish(uint32_t sp)
+{
+    uint32_t words = 0;
+
+    m_dump.sp = sp;
+    if ((sp >= RAM_START) && (sp < (uint32_t)&__StackTop) && ((sp & 3) == 0))
+    {
+        words = MIN(((uint32_t)&__StackTop - sp) / sizeof(uint32_t), APP_FAULT_STACK_WORDS);
+        memcpy(m_dump.stack, (void const *)sp, words * sizeof(uint32_t));
+    }
+    m_dump.stack_words = words;
+    m_dump.magic       = APP_FAULT_MAGIC;
+    m_dump.check       = dump_check();
+
+#ifdef CRASH_LOG_ENABLED
+    crash_log_seal();
+#endif
+    NVIC_SystemReset();
+}
+
+
+uint32_t app_fault_init(void)
+{
+    // A power-on or brown-out reset leaves RESETREAS empty; RAM content is undefined then.
+    m_dump_found = (NRF_POWER->RESETREAS != 0) && (m_dump.magic == APP_FAULT_MAGIC) &&
+                   (m_dump.check == dump_check());
+    if (!m_dump_found)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    // Not reported again after a later reset which leaves no dump of its own.
+    m_dump.magic        = APP_FAULT_MAGIC_READ;
+    m_dump.reset_reason = NRF_POWER->RESETREAS;
+    return NRF_SUCCESS;
+}
+
+
+app_fault_dump_t const * app_fault_last_get(void)
+{
+    return m_dump_found ? &m_dump : NULL;
+}
+
+
+void app_fault_error_record(uint32_t error_code, uint32_t line_num, uint8_t const * p_file_name,
+                            uint32_t pc)
+{
+    __disable_irq();
+
+    memset(&m_dump.frame, 0, sizeof(m_dump.frame));
+    m_dump.type       = APP_FAULT_TYPE_ERROR;
+    m_dump.error_code = error_code;
+    m_dump.line       = line_num;
+    m_dump.p_file     = p_file_name;
+    m_dump.frame.lr   = pc;
+    m_dump.frame.pc   = pc;
+    m_dump.exc_return = 0;
+
+    dump_finish(__get_MSP());
+}
+
+
+/**@brief Function for recording a HardFault, called by HardFault_Handler with the stacked frame.
+ */
+void app_fault_hardfault_record(app_fault_frame_t const * p_frame, uint32_t exc_return)
+{
+    m_dump.type       = APP_FAULT_TYPE_HARDFAULT;
+    m_dump.error_code = 0;
+    m_dump.line       = 0;
+    m_dump.p_file     = NULL;
+    m_dump.exc_return = exc_return;
+    if (((uint32_t)p_frame >= RAM_START) &&
+        ((uint32_t)p_frame + sizeof(*p_frame) <= (uint32_t)&__StackTop))
+    {
+        m_dump.frame = *p_frame;
+    }
+    else
+    {
+        memset(&m_dump.frame, 0, sizeof(m_dump.frame));
+    }
+
+    // The stack as it was before the exception, above the frame.
+    dump_finish((uint32_t)p_frame + sizeof(*p_frame));
+}
+
+
+/**@brief HardFault handler, passing the exception frame on the stack in use to
+ *        app_fault_hardfault_record().
+ *
+ * @details Bit 2 of EXC_RETURN tells whether the frame was pushed on the process or the main
+ *          stack. Naked, so that no register is pushed before the frame is located.
+ */
+void HardFault_Handler(void) __attribute__((naked));
+void HardFault_Handler(void)
+{
+    __ASM volatile(
+        ".syntax unified                    \n"
+        "   movs r0, #4                     \n"
+        "   mov  r1, lr                     \n"
+        "   tst  r0, r1                     \n"
+        "   beq  1f                         \n"
+        "   mrs  r0, psp                    \n"
+        "   b    2f                         \n"
+        "1: mrs  r0, msp                    \n"
+        "2: ldr  r2, =app_fault_hardfault_record \n"
+        "   bx   r2                         \n"
+        "   .ltorg                          \n"
+        ".syntax divided                    \n"
+    );
+}
+
+/** @} */
@@ -0,0 +1,100 @@
+/** @file
+ *
+ * @defgroup app_fault Fault capture
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Post-mortem dump of the last error or HardFault, kept in RAM across the reset.
+ *
+ * @details @ref app_error_handler (with APP_FAULT_ENABLED defined) and the HardFault handler
+ *          of this module fill in an @ref app_fault_dump_t in the .noinit section and reset the
+ *          chip at once; no flash is written, so the reboot follows within the time the
+ *          capture takes, a few hundred cycles. The dump holds:
+ *          - the error code, line and file of an error, or the exception frame of a HardFault
+ *            (r0 to r3, r12, lr, pc, xPSR) with EXC_RETURN;
+ *          - the stack pointer and the first @ref APP_FAULT_STACK_WORDS words above it;
+ *          - the reset reason seen on the next boot.
+ *
+ *          For an error, pc is the return address of the APP_ERROR_CHECK() call, so the call
+ *          site can be found in release builds too, where the line and file are 0.
+ *
+ *          On the next boot, @ref app_fault_init accepts the dump if it is intact and RAM was
+ *          kept powered, as for the crash log (see @ref crash_log). WaterLED prints it over RTT
+ *          in the format read by host/fault_decode, which resolves the addresses against the
+ *          ELF file.
+ */
+
+#ifndef APP_FAULT_H__
+#define APP_FAULT_H__
+
+#include <stdint.h>
+
+#ifndef APP_FAULT_STACK_WORDS
+#define APP_FAULT_STACK_WORDS   32      /**< Stack words kept, from the stack pointer up. */
+#endif
+
+/**@brief Kinds of dump. */
+typedef enum
+{
+    APP_FAULT_TYPE_ERROR = 1,           /**< @ref app_error_handler was called. */
+    APP_FAULT_TYPE_HARDFAULT            /**< A HardFault occurred. */
+} app_fault_type_t;
+
+/**@brief Registers stacked on exception entry, in stacking order. */
+typedef struct
+{
+    uint32_t r0;
+    uint32_t r1;
+    uint32_t r2;
+    uint32_t r3;
+    uint32_t r12;
+    uint32_t lr;
+    uint32_t pc;
+    uint32_t xpsr;
+} app_fault_frame_t;
+
+/**@brief Dump of the last fault. */
+typedef struct
+{
+    uint32_t          magic;            /**< Marks a dump written by this module. */
+    uint32_t          type;             /**< app_fault_type_t. */
+    uint32_t          error_code;       /**< Error code given to app_error_handler, 0 for a HardFault. */
+    uint32_t          line;             /**< Line of the error, 0 if not known. */
+    uint8_t const *   p_file;           /**< File of the error, in flash, NULL if not known. */
+    app_fault_frame_t frame;            /**< Exception frame; for an error only lr and pc are set. */
+    uint32_t          exc_return;       /**< EXC_RETURN of the HardFault, 0 for an error. */
+    uint32_t          sp;               /**< Stack pointer at the fault, above the frame. */
+    uint32_t          stack_words;      /**< Number of words in stack. */
+    uint32_t          stack[APP_FAULT_STACK_WORDS];    /**< Stack contents from sp up. */
+    uint32_t          reset_reason;     /**< RESETREAS read on the boot after the fault. */
+    uint32_t          check;            /**< Inverted sum of the words above, excluding reset_reason. */
+} app_fault_dump_t;
+
+/**@brief Function for picking up the dump left by the last fault.
+ *
+ * @details Must be called at startup before RESETREAS is cleared, e.g. by @ref app_pm_init.
+ *
+ * @retval NRF_SUCCESS          If a dump was found; see @ref app_fault_last_get.
+ * @retval NRF_ERROR_NOT_FOUND  If there was no valid dump.
+ */
+uint32_t app_fault_init(void);
+
+/**@brief Function for getting the dump found by @ref app_fault_init.
+ *
+ * @return Dump, or NULL if none was found.
+ */
+app_fault_dump_t const * app_fault_last_get(void);
+
+/**@brief Function for recording an error and resetting the chip; called by app_error_handler.
+ *
+ * @param[in] error_code   Error code.
+ * @param[in] line_num     Line number, 0 if not known.
+ * @param[in] p_file_name  File name, NULL if not known.
+ * @param[in] pc           Return address of the app_error_handler call.
+ */
+void app_fault_error_record(uint32_t error_code, uint32_t line_num, uint8_t const * p_file_name,
+                            uint32_t pc);
+
+#endif // APP_FAULT_H__
+
+/** @} */
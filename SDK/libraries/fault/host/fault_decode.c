@@ -0,0 +1,319 @@
+/** @file
+ *
+ * @brief Host decoder of the fault dump printed by WaterLED.
+ *
+ * @details Reads the "FAULT <key> <value>" lines written by fault_print() from stdin, e.g. an
+ *          RTT log, ignoring everything else, and prints:
+ *          - the kind of fault, the reset reason and, for an error, the NRF_ERROR name;
+ *          - for a HardFault, the faulting function and line from pc, the caller from lr and
+ *            the exception the fault was taken in, from xPSR;
+ *          - for an error, the call site of APP_ERROR_CHECK(), which is also known in release
+ *            builds where line and file are 0;
+ *          - a best-effort backtrace: stack words which look like Thumb return addresses, i.e.
+ *            odd and within flash, past the vector table. Stale return addresses left in the stack by calls which have
+ *            returned are listed too; treat the list as a hint.
+ *
+ *          Addresses are resolved with addr2line on the ELF file given as argument. A return
+ *          address is moved back by 2 bytes, into the BL instruction, so the line of the call is
+ *          reported rather than the line after it.
+ *
+ *          Exits with 1 if no dump was found.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nrf_error.h"
+
+#define FLASH_END       0x40000UL   /**< End of the nRF51822 flash; return addresses lie below. */
+#define VECTORS_END     0xC0UL      /**< End of the vector table; return addresses lie above. */
+#define STACK_WORDS_MAX 256         /**< Stack words read, at least APP_FAULT_STACK_WORDS. */
+#define LINE_SIZE       512
+
+/**@brief Dump as read from the log. */
+typedef struct
+{
+    bool     found;
+    bool     hardfault;
+    uint32_t reset;
+    uint32_t code;
+    uint32_t line;
+    char     file[LINE_SIZE];
+    uint32_t r[8];                  /**< r0, r1, r2, r3, r12, lr, pc, xpsr. */
+    uint32_t exc_return;
+    uint32_t sp;
+    uint32_t stack[STACK_WORDS_MAX];
+    uint32_t stack_words;
+} dump_t;
+
+static const char * const m_reg_names[] = {"r0", "r1", "r2", "r3", "r12", "lr", "pc", "xpsr"};
+
+#define ERROR_NAME(CODE)    {CODE, #CODE}
+
+static const struct
+{
+    uint32_t     code;
+    const char * p_name;
+} m_error_names[] =
+{
+    ERROR_NAME(NRF_SUCCESS),
+    ERROR_NAME(NRF_ERROR_SVC_HANDLER_MISSING),
+    ERROR_NAME(NRF_ERROR_SOFTDEVICE_NOT_ENABLED),
+    ERROR_NAME(NRF_ERROR_INTERNAL),
+    ERROR_NAME(NRF_ERROR_NO_MEM),
+    ERROR_NAME(NRF_ERROR_NOT_FOUND),
+    ERROR_NAME(NRF_ERROR_NOT_SUPPORTED),
+    ERROR_NAME(NRF_ERROR_INVALID_PARAM),
+    ERROR_NAME(NRF_ERROR_INVALID_STATE),
+    ERROR_NAME(NRF_ERROR_INVALID_LENGTH),
+    ERROR_NAME(NRF_ERROR_INVALID_FLAGS),
+    ERROR_NAME(NRF_ERROR_INVALID_DATA),
+    ERROR_NAME(NRF_ERROR_DATA_SIZE),
+    ERROR_NAME(NRF_ERROR_TIMEOUT),
+    ERROR_NAME(NRF_ERROR_NULL),
+    ERROR_NAME(NRF_ERROR_FORBIDDEN),
+    ERROR_NAME(NRF_ERROR_INVALID_ADDR),
+    ERROR_NAME(NRF_ERROR_BUSY),
+};
+
+/**@brief RESETREAS bits. */
+static const struct
+{
+    uint32_t     mask;
+    const char * p_name;
+} m_reset_names[] =
+{
+    {1UL << 0,  "pin"},
+    {1UL << 1,  "watchdog"},
+    {1UL << 2,  "soft reset"},
+    {1UL << 3,  "lockup"},
+    {1UL << 16, "wake from System OFF by GPIO"},
+    {1UL << 17, "wake from System OFF by LPCOMP"},
+    {1UL << 18, "debug interface"},
+};
+
+static const char * m_elf;
+static const char * m_addr2line;
+
+
+/**@brief Function for printing the function and line of an address, from addr2line. */
+static void addr_print(const char * p_label, uint32_t addr)
+{
+    char command[LINE_SIZE];
+    char result[LINE_SIZE];
+    FILE * p_pipe;
+
+    printf("  %-10s 0x%08x", p_label, addr);
+    snprintf(command, sizeof(command), "%s -f -p -C -e '%s' 0x%x", m_addr2line, m_elf, addr);
+    p_pipe = popen(command, "r");
+    if ((p_pipe != NULL) && (fgets(result, sizeof(result), p_pipe) != NULL))
+    {
+        printf("  %s", result);
+    }
+    else
+    {
+        printf("\n");
+    }
+    if (p_pipe != NULL)
+    {
+        (void)pclose(p_pipe);
+    }
+}
+
+
+/**@brief Function for getting the address of the call which a return address points after. */
+static uint32_t call_site(uint32_t return_addr)
+{
+    return (return_addr & ~1UL) - 2;
+}
+
+
+static bool is_return_addr(uint32_t word)
+{
+    return ((word & 1) != 0) && (word > VECTORS_END) && (word < FLASH_END);
+}
+
+
+/**@brief Function for reading one "FAULT <key> <value>..." line into the dump. */
+static void line_parse(dump_t * p_dump, char * p_line)
+{
+    char *   p_key = strstr(p_line, "FAULT ");
+    char *   p_value;
+    char *   p_end;
+    uint32_t i;
+
+    if (p_key == NULL)
+    {
+        return;
+    }
+    p_key  += strlen("FAULT ");
+    p_line  = p_key + strcspn(p_key, " \r\n");
+    p_value = p_line + strspn(p_line, " ");
+    *p_line = '\0';
+    p_value[strcspn(p_value, "\r\n")] = '\0';
+
+    if (strcmp(p_key, "type") == 0)
+    {
+        // A new dump replaces one read before.
+        memset(p_dump, 0, sizeof(*p_dump));
+        p_dump->found     = true;
+        p_dump->hardfault = (strcmp(p_value, "hardfault") == 0);
+    }
+    else if (strcmp(p_key, "reset") == 0)
+    {
+        p_dump->reset = strtoul(p_value, NULL, 0);
+    }
+    else if (strcmp(p_key, "code") == 0)
+    {
+        p_dump->code = strtoul(p_value, NULL, 0);
+    }
+    else if (strcmp(p_key, "line") == 0)
+    {
+        p_dump->line = strtoul(p_value, NULL, 0);
+    }
+    else if (strcmp(p_key, "file") == 0)
+    {
+        snprintf(p_dump->file, sizeof(p_dump->file), "%s", p_value);
+    }
+    else if (strcmp(p_key, "exc_return") == 0)
+    {
+        p_dump->exc_return = strtoul(p_value, NULL, 0);
+    }
+    else if (strcmp(p_key, "sp") == 0)
+    {
+        p_dump->sp = strtoul(p_value, NULL, 0);
+    }
+    else if (strcmp(p_key, "stack") == 0)
+    {
+        while ((*p_value != '\0') && (p_dump->stack_words < STACK_WORDS_MAX))
+        {
+            p_dump->stack[p_dump->stack_words++] = strtoul(p_value, &p_end, 0);
+            if (p_end == p_value)
+            {
+                p_dump->stack_words--;
+                break;
+            }
+            p_value = p_end;
+        }
+    }
+    else
+    {
+        for (i = 0; i < sizeof(m_reg_names) / sizeof(m_reg_names[0]); i++)
+        {
+            if (strcmp(p_key, m_reg_names[i]) == 0)
+            {
+                p_dump->r[i] = strtoul(p_value, NULL, 0);
+            }
+        }
+    }
+}
+
+
+static void dump_print(dump_t const * p_dump)
+{
+    uint32_t lr   = p_dump->r[5];
+    uint32_t pc   = p_dump->r[6];
+    uint32_t ipsr = p_dump->r[7] & 0x3F;
+    uint32_t i;
+
+    printf("%s, reset reason 0x%08x:", p_dump->hardfault ? "HardFault" : "Error", p_dump->reset);
+    for (i = 0; i < sizeof(m_reset_names) / sizeof(m_reset_names[0]); i++)
+    {
+        if ((p_dump->reset & m_reset_names[i].mask) != 0)
+        {
+            printf(" %s", m_reset_names[i].p_name);
+        }
+    }
+    printf("\n");
+
+    if (p_dump->hardfault)
+    {
+        if (ipsr == 0)
+        {
+            printf("  in thread mode, on the %s stack\n",
+                   ((p_dump->exc_return & 4) != 0) ? "process" : "main");
+        }
+        else
+        {
+            printf("  in exception %u (IRQn %d)\n", ipsr, (int)ipsr - 16);
+        }
+        for (i = 0; i < 5; i++)
+        {
+            printf("  %-10s 0x%08x\n", m_reg_names[i], p_dump->r[i]);
+        }
+        addr_print("pc", pc & ~1UL);
+        if ((lr & 0xFFFFFFF0UL) == 0xFFFFFFF0UL)
+        {
+            printf("  %-10s 0x%08x  EXC_RETURN, the fault hit the first instruction of a handler\n",
+                   "lr", lr);
+        }
+        else
+        {
+            addr_print("lr", call_site(lr));
+        }
+    }
+    else
+    {
+        printf("  code       0x%08x", p_dump->code);
+        for (i = 0; i < sizeof(m_error_names) / sizeof(m_error_names[0]); i++)
+        {
+            if (m_error_names[i].code == p_dump->code)
+            {
+                printf("  %s", m_error_names[i].p_name);
+            }
+        }
+        printf("\n");
+        if (p_dump->line != 0)
+        {
+            printf("  at         %s:%u\n", p_dump->file, p_dump->line);
+        }
+        addr_print("called at", call_site(pc));
+    }
+
+    printf("  sp         0x%08x, %u stack words\n", p_dump->sp, p_dump->stack_words);
+    printf("Possible return addresses on the stack:\n");
+    for (i = 0; i < p_dump->stack_words; i++)
+    {
+        if (is_return_addr(p_dump->stack[i]))
+        {
+            char label[16];
+
+            snprintf(label, sizeof(label), "sp+%u", 4 * i);
+            addr_print(label, call_site(p_dump->stack[i]));
+        }
+    }
+}
+
+
+int main(int argc, char ** argv)
+{
+    static dump_t dump;
+    char          line[LINE_SIZE];
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s app.elf < log\n", argv[0]);
+        return 2;
+    }
+    m_elf       = argv[1];
+    m_addr2line = getenv("ADDR2LINE");
+    if (m_addr2line == NULL)
+    {
+        m_addr2line = "arm-none-eabi-addr2line";
+    }
+
+    while (fgets(line, sizeof(line), stdin) != NULL)
+    {
+        line_parse(&dump, line);
+    }
+
+    if (!dump.found)
+    {
+        fprintf(stderr, "no FAULT lines found\n");
+        return 1;
+    }
+    dump_print(&dump);
+    return 0;
+}
@@ -73,7 +73,7 @@ uint32_t app_fifo_init(app_fifo_t * p_fifo, uint8_t * p_buf, uint16_t buf_size)
 }
 
 
-uint32_t app_fifo_put(app_fifo_t * p_fifo, uint8_t byte)
+__RAMFUNC uint32_t app_fifo_put(app_fifo_t * p_fifo, uint8_t byte)
 {
     if (FIFO_LENGTH <= p_fifo->buf_size_mask)
     {
@@ -85,7 +85,7 @@ uint32_t app_fifo_put(app_fifo_t * p_fifo, uint8_t byte)
 }
 
 
-uint32_t app_fifo_get(app_fifo_t * p_fifo, uint8_t * p_byte)
+__RAMFUNC uint32_t app_fifo_get(app_fifo_t * p_fifo, uint8_t * p_byte)
 {
     if (FIFO_LENGTH != 0)
     {
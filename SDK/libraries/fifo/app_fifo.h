@@ -24,6 +24,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include "compiler_abstraction.h"
 
 /**@brief   A FIFO instance structure. 
  * @details Keeps track of which bytes to read and write next.
@@ -57,8 +58,10 @@ uint32_t app_fifo_init(app_fifo_t * p_fifo, uint8_t * p_buf, uint16_t buf_size);
  *
  * @retval     NRF_SUCCESS              If an element has been successfully added to the FIFO.
  * @retval     NRF_ERROR_NO_MEM         If the FIFO is full.
+ *
+ * @note       Runs from RAM, see __RAMFUNC in compiler_abstraction.h.
  */
-uint32_t app_fifo_put(app_fifo_t * p_fifo, uint8_t byte);
+__RAMFUNC uint32_t app_fifo_put(app_fifo_t * p_fifo, uint8_t byte);
 
 /**@brief Function for getting the next element from the FIFO.
  *
@@ -67,8 +70,10 @@ uint32_t app_fifo_put(app_fifo_t * p_fifo, uint8_t byte);
  *
  * @retval     NRF_SUCCESS              If an element was returned.
  * @retval     NRF_ERROR_NOT_FOUND      If there are no more elements in the queue.
+ *
+ * @note       Runs from RAM, see __RAMFUNC in compiler_abstraction.h.
  */
-uint32_t app_fifo_get(app_fifo_t * p_fifo, uint8_t * p_byte);
+__RAMFUNC uint32_t app_fifo_get(app_fifo_t * p_fifo, uint8_t * p_byte);
 
 /**@brief Function for flushing the FIFO.
  *
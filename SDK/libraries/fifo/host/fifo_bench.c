@@ -0,0 +1,145 @@
+/** @file
+ *
+ * @brief Host bench of app_fifo, the buffer between the UART interrupt and the application.
+ *
+ * @details Times single bytes through app_fifo_put() and app_fifo_get(), as the interrupt
+ *          path moves them, and blocks through app_fifo_write() and app_fifo_read(), and checks
+ *          that every byte comes out as it went in. The times are those of the build machine;
+ *          they compare changes to app_fifo.c, while the bench shell command gives the cycles
+ *          on the nRF51.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "app_fifo.h"
+#include "nrf_error.h"
+
+#define BUF_SIZE            256     /**< Size of the FIFO, as APP_UART_BUF_SIZE. */
+#define BLOCK_SIZE          64      /**< Bytes per app_fifo_write() and app_fifo_read(). */
+#define DEFAULT_ROUNDS      100000
+
+static app_fifo_t m_fifo;
+static uint8_t    m_buf[BUF_SIZE];
+
+
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+
+static void fail(const char * p_what)
+{
+    fprintf(stderr, "fifo_bench: %s\n", p_what);
+    exit(1);
+}
+
+
+/**@brief Puts BUF_SIZE bytes, then gets them back, for each round. */
+static double bytes_run(uint32_t rounds)
+{
+    double   start = now_ns();
+    uint32_t round;
+    uint32_t i;
+    uint8_t  byte;
+
+    for (round = 0; round < rounds; round++)
+    {
+        for (i = 0; i < BUF_SIZE; i++)
+        {
+            if (app_fifo_put(&m_fifo, (uint8_t)(round + i)) != NRF_SUCCESS)
+            {
+                fail("put failed");
+            }
+        }
+        if (app_fifo_put(&m_fifo, 0) != NRF_ERROR_NO_MEM)
+        {
+            fail("put into a full FIFO");
+        }
+        for (i = 0; i < BUF_SIZE; i++)
+        {
+            if ((app_fifo_get(&m_fifo, &byte) != NRF_SUCCESS) || (byte != (uint8_t)(round + i)))
+            {
+                fail("get returned a wrong byte");
+            }
+        }
+        if (app_fifo_get(&m_fifo, &byte) != NRF_ERROR_NOT_FOUND)
+        {
+            fail("get from an empty FIFO");
+        }
+    }
+    return (now_ns() - start) / ((double)rounds * BUF_SIZE);
+}
+
+
+/**@brief Writes BLOCK_SIZE bytes and reads them back, for each round. */
+static double blocks_run(uint32_t rounds)
+{
+    uint8_t  in[BLOCK_SIZE];
+    uint8_t  out[BLOCK_SIZE];
+    double   start = now_ns();
+    uint32_t round;
+    uint32_t size;
+    uint32_t i;
+
+    for (round = 0; round < rounds; round++)
+    {
+        for (i = 0; i < BLOCK_SIZE; i++)
+        {
+            in[i] = (uint8_t)(round ^ i);
+        }
+        size = BLOCK_SIZE;
+        if ((app_fifo_write(&m_fifo, in, &size) != NRF_SUCCESS) || (size != BLOCK_SIZE))
+        {
+            fail("write failed");
+        }
+        size = BLOCK_SIZE;
+        if ((app_fifo_read(&m_fifo, out, &size) != NRF_SUCCESS) || (size != BLOCK_SIZE))
+        {
+            fail("read failed");
+        }
+        for (i = 0; i < BLOCK_SIZE; i++)
+        {
+            if (out[i] != in[i])
+            {
+                fail("read returned a wrong byte");
+            }
+        }
+    }
+    return (now_ns() - start) / ((double)rounds * BLOCK_SIZE);
+}
+
+
+int main(int argc, char ** argv)
+{
+    uint32_t rounds = DEFAULT_ROUNDS;
+
+    if (argc > 2)
+    {
+        fprintf(stderr, "usage: %s [rounds]\n", argv[0]);
+        return 2;
+    }
+    if (argc == 2)
+    {
+        rounds = (uint32_t)strtoul(argv[1], NULL, 0);
+        if (rounds == 0)
+        {
+            fprintf(stderr, "rounds must be at least 1\n");
+            return 2;
+        }
+    }
+
+    if (app_fifo_init(&m_fifo, m_buf, BUF_SIZE) != NRF_SUCCESS)
+    {
+        fail("init failed");
+    }
+
+    printf("put+get    %6.2f ns/byte\n", bytes_run(rounds));
+    printf("write+read %6.2f ns/byte, blocks of %u\n", blocks_run(rounds), BLOCK_SIZE);
+    return 0;
+}
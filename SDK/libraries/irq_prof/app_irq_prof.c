@@ -0,0 +1,201 @@
+/** @file
+ *
+ * @defgroup app_irq_prof Interrupt profiler
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Latency, execution time and nesting of interrupt handlers.
+ */
+
+#include "app_irq_prof.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "nrf.h"
+#include "app_util.h"
+#include "app_util_platform.h"
+#include "app_timestamp.h"
+#ifdef SOFTDEVICE_PRESENT
+#include "nrf_sdm.h"
+#include "nrf_soc.h"
+#endif
+
+STATIC_ASSERT(APP_IRQ_PROF_PPI_CH_FIRST + APP_IRQ_PROF_LATENCY_SOURCES <= 16);
+STATIC_ASSERT(APP_IRQ_PROF_LATENCY_SOURCES < APP_TIMESTAMP_CC);
+
+/**@brief Event captured into TIMER2 CC[n] for latency source n. */
+typedef struct
+{
+    IRQn_Type           irqn;       /**< Interrupt raised by the event. */
+    volatile uint32_t * p_event;    /**< Event register. */
+} latency_source_t;
+
+/**@brief Latency sources, the interrupts whose latency matters most: timer expiry and UART
+ *        reception, which has a single byte of buffering. */
+static const latency_source_t m_sources[APP_IRQ_PROF_LATENCY_SOURCES] =
+{
+    {RTC1_IRQn,  &NRF_RTC1->EVENTS_COMPARE[0]},
+    {UART0_IRQn, &NRF_UART0->EVENTS_RXDRDY},
+};
+
+static app_irq_prof_stats_t * volatile m_p_stats;   /**< Listed handlers, most recently listed first. */
+static volatile uint8_t                m_depth;     /**< Handlers running. */
+
+
+#ifdef SOFTDEVICE_PRESENT
+static bool softdevice_enabled(void)
+{
+    uint8_t enabled;
+
+    return (sd_softdevice_is_enabled(&enabled) == NRF_SUCCESS) && (enabled != 0);
+}
+#endif
+
+
+/**@brief Function for finding the histogram bucket of a time. */
+static uint8_t bucket_get(uint16_t us)
+{
+    uint8_t bucket = 0;
+
+    while ((us != 0) && (bucket < APP_IRQ_PROF_BUCKETS - 1))
+    {
+        us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+
+void app_irq_prof_init(void)
+{
+    uint32_t mask = 0;
+    uint8_t  i;
+
+    for (i = 0; i < APP_IRQ_PROF_LATENCY_SOURCES; i++)
+    {
+#ifdef SOFTDEVICE_PRESENT
+        if (softdevice_enabled())
+        {
+            (void)sd_ppi_channel_assign(APP_IRQ_PROF_PPI_CH_FIRST + i, m_sources[i].p_event,
+                                        &NRF_TIMER2->TASKS_CAPTURE[i]);
+            mask |= 1UL << (APP_IRQ_PROF_PPI_CH_FIRST + i);
+            continue;
+        }
+#endif
+        NRF_PPI->CH[APP_IRQ_PROF_PPI_CH_FIRST + i].EEP = (uint32_t)m_sources[i].p_event;
+        NRF_PPI->CH[APP_IRQ_PROF_PPI_CH_FIRST + i].TEP = (uint32_t)&NRF_TIMER2->TASKS_CAPTURE[i];
+        mask |= 1UL << (APP_IRQ_PROF_PPI_CH_FIRST + i);
+    }
+
+#ifdef SOFTDEVICE_PRESENT
+    if (softdevice_enabled())
+    {
+        (void)sd_ppi_channel_enable_set(mask);
+        return;
+    }
+#endif
+    NRF_PPI->CHENSET = mask;
+}
+
+
+uint16_t app_irq_prof_enter(app_irq_prof_stats_t * p_stats)
+{
+    uint16_t start = app_timestamp_get();
+    uint16_t latency;
+    uint8_t  depth;
+    int8_t   i;
+
+    // A preempting handler increments and decrements again before this one resumes.
+    depth   = m_depth + 1;
+    m_depth = depth;
+
+    if (p_stats->source == -2)
+    {
+        p_stats->source = -1;
+        for (i = 0; i < APP_IRQ_PROF_LATENCY_SOURCES; i++)
+        {
+            if (m_sources[i].irqn == p_stats->irqn)
+            {
+                p_stats->source = i;
+            }
+        }
+    }
+
+    if ((p_stats->source >= 0) && (*m_sources[p_stats->source].p_event != 0))
+    {
+        latency = (uint16_t)(start - NRF_TIMER2->CC[p_stats->source]);
+        p_stats->latency[bucket_get(latency)]++;
+        if (latency > p_stats->latency_max)
+        {
+            p_stats->latency_max = latency;
+        }
+    }
+
+    p_stats->count++;
+    if (depth > 1)
+    {
+        p_stats->nested++;
+    }
+    if (depth > p_stats->depth_max)
+    {
+        p_stats->depth_max = depth;
+    }
+
+    return start;
+}
+
+
+void app_irq_prof_exit(app_irq_prof_stats_t * p_stats, uint16_t start)
+{
+    uint16_t elapsed = app_timestamp_elapsed(start);
+    uint32_t primask;
+
+    p_stats->exec[bucket_get(elapsed)]++;
+    if (elapsed > p_stats->exec_max)
+    {
+        p_stats->exec_max = elapsed;
+    }
+
+    if (!p_stats->listed)
+    {
+        // Handlers of other priorities may be listing themselves too.
+        primask = __get_PRIMASK();
+        __disable_irq();
+        p_stats->listed = 1;
+        p_stats->p_next = m_p_stats;
+        m_p_stats       = p_stats;
+        if (primask == 0)
+        {
+            __enable_irq();
+        }
+    }
+
+    m_depth--;
+}
+
+
+app_irq_prof_stats_t const * app_irq_prof_stats_get(void)
+{
+    return m_p_stats;
+}
+
+
+void app_irq_prof_reset(void)
+{
+    app_irq_prof_stats_t * p_stats;
+
+    for (p_stats = m_p_stats; p_stats != NULL; p_stats = p_stats->p_next)
+    {
+        CRITICAL_REGION_ENTER();
+        p_stats->count       = 0;
+        p_stats->nested      = 0;
+        p_stats->depth_max   = 0;
+        p_stats->exec_max    = 0;
+        p_stats->latency_max = 0;
+        memset(p_stats->exec, 0, sizeof(p_stats->exec));
+        memset(p_stats->latency, 0, sizeof(p_stats->latency));
+        CRITICAL_REGION_EXIT();
+    }
+}
+
+/** @} */
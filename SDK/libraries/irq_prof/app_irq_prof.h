@@ -0,0 +1,110 @@
+/** @file
+ *
+ * @defgroup app_irq_prof Interrupt profiler
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Latency, execution time and nesting of interrupt handlers.
+ *
+ * @details In builds with APP_IRQ_PROFILE defined, a handler which starts with
+ *          APP_IRQ_PROF_ENTER() and ends with APP_IRQ_PROF_EXIT() gets a static
+ *          @ref app_irq_prof_stats_t, which joins the list returned by
+ *          @ref app_irq_prof_stats_get on the first interrupt. Times come from the free-running
+ *          TIMER2 of @ref app_timestamp, since the Cortex-M0 has no cycle counter:
+ *          - Execution time, from entry to exit of the handler, including the handlers which
+ *            preempted it.
+ *          - Latency, from the peripheral event to the entry of the handler. The event is
+ *            captured into TIMER2 CC[n] by PPI, which is only done for the events in
+ *            @ref APP_IRQ_PROF_LATENCY_SOURCES: RTC1 COMPARE[0] and UART0 RXDRDY. The
+ *            latency is recorded when the event is still set at entry.
+ *          - Depth: the number of handlers running, this one included, at entry.
+ *
+ *          Times go into histograms of 2^n microsecond buckets: bucket 0 counts 0 us, bucket n
+ *          counts 2^(n-1) to 2^n - 1 us, and the last bucket everything longer. The profiler
+ *          adds a few microseconds to each handler, and the resolution is 1 us.
+ *
+ * @note    @ref app_timestamp_init and then @ref app_irq_prof_init must be called before the
+ *          interrupts are enabled. PPI channels APP_IRQ_PROF_PPI_CH_FIRST and the next one are
+ *          taken; under S110 they must be among 0 to 7.
+ */
+
+#ifndef APP_IRQ_PROF_H__
+#define APP_IRQ_PROF_H__
+
+#include <stdint.h>
+#include "compiler_abstraction.h"
+
+#ifndef APP_IRQ_PROF_PPI_CH_FIRST
+#define APP_IRQ_PROF_PPI_CH_FIRST   6       /**< First PPI channel capturing an event into TIMER2. */
+#endif
+
+#define APP_IRQ_PROF_LATENCY_SOURCES 2      /**< Events captured, into TIMER2 CC[0] and CC[1]. */
+#define APP_IRQ_PROF_BUCKETS        8       /**< Histogram buckets. */
+
+/**@brief Statistics of one interrupt handler. */
+typedef struct app_irq_prof_stats_s
+{
+    struct app_irq_prof_stats_s * p_next;           /**< Next handler in the list. */
+    char const *                  p_name;           /**< Name of the interrupt. */
+    int8_t                        irqn;             /**< Interrupt number. */
+    int8_t                        source;           /**< Latency source, -1 if none, -2 if not looked up yet. */
+    uint8_t                       listed;           /**< The handler is in the list. */
+    uint8_t                       depth_max;        /**< Deepest nesting at entry, this handler included. */
+    uint32_t                      count;            /**< Interrupts handled. */
+    uint32_t                      nested;           /**< Interrupts which preempted another handler. */
+    uint16_t                      exec_max;         /**< Longest execution time, in us. */
+    uint16_t                      latency_max;      /**< Longest latency, in us. */
+    uint16_t                      exec[APP_IRQ_PROF_BUCKETS];       /**< Execution time histogram. */
+    uint16_t                      latency[APP_IRQ_PROF_BUCKETS];    /**< Latency histogram. */
+} app_irq_prof_stats_t;
+
+#ifdef APP_IRQ_PROFILE
+
+/**@brief Starts profiling a handler; must be the first statement of the handler. */
+#define APP_IRQ_PROF_ENTER(IRQN)                                                            \
+    static app_irq_prof_stats_t IRQ_PROF_STATS = {0, #IRQN, (IRQN), -2};                    \
+    uint16_t IRQ_PROF_START = app_irq_prof_enter(&IRQ_PROF_STATS)
+
+/**@brief Records the handler; must be the last statement of the handler. */
+#define APP_IRQ_PROF_EXIT()                                                                 \
+    app_irq_prof_exit(&IRQ_PROF_STATS, IRQ_PROF_START)
+
+#else
+
+#define APP_IRQ_PROF_ENTER(IRQN)    /**< Interrupts are not profiled. */
+#define APP_IRQ_PROF_EXIT()         /**< Interrupts are not profiled. */
+
+#endif // APP_IRQ_PROFILE
+
+/**@brief Function for connecting the latency sources to TIMER2 captures through PPI. */
+void app_irq_prof_init(void);
+
+/**@brief Function for recording the entry of a handler.
+ *
+ * @param[in] p_stats  Statistics of the handler.
+ *
+ * @return Entry timestamp, to pass to @ref app_irq_prof_exit.
+ *
+ * @note Long calls, since UART0_IRQHandler runs from RAM.
+ */
+__LONG_CALL uint16_t app_irq_prof_enter(app_irq_prof_stats_t * p_stats);
+
+/**@brief Function for recording the exit of a handler.
+ *
+ * @param[in] p_stats  Statistics of the handler.
+ * @param[in] start    Timestamp returned by @ref app_irq_prof_enter.
+ */
+__LONG_CALL void app_irq_prof_exit(app_irq_prof_stats_t * p_stats, uint16_t start);
+
+/**@brief Function for getting the handlers which have run.
+ *
+ * @return First handler, most recently listed first, or NULL. Follow p_next for the others.
+ */
+app_irq_prof_stats_t const * app_irq_prof_stats_get(void);
+
+/**@brief Function for clearing the statistics of every listed handler. */
+void app_irq_prof_reset(void);
+
+#endif // APP_IRQ_PROF_H__
+
+/** @} */
@@ -0,0 +1,320 @@
+/** @file
+ *
+ * @defgroup app_led LED pattern engine
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Blink, breathe and chase patterns played by TIMER1, PPI and GPIOTE.
+ */
+
+#include "app_led.h"
+#include <stddef.h>
+#include <string.h>
+#include "nrf.h"
+#include "nrf_error.h"
+#include "nrf_gpio.h"
+#include "app_timer.h"
+#ifdef SOFTDEVICE_PRESENT
+#include "nrf_sdm.h"
+#include "nrf_soc.h"
+#endif
+
+#define PERIOD_CC       3                                       /**< TIMER1 compare register ending the period. */
+#define PPI_MASK_ALL    (0x3FUL << APP_LED_PPI_CH_FIRST)        /**< Two PPI channels per LED. */
+
+STATIC_ASSERT(APP_LED_GPIOTE_CH_FIRST + APP_LED_COUNT <= 4);
+STATIC_ASSERT(APP_LED_PPI_CH_FIRST + 2 * APP_LED_COUNT <= 16);
+
+APP_TIMER_DEF(m_segment_timer);                     /**< Single-shot timer ending the current segment. */
+static uint8_t                   m_pins[APP_LED_COUNT]; /**< Pins of the LEDs. */
+static bool                      m_active_high;     /**< The LEDs are on when their pin is high. */
+static app_led_pattern_t const * m_p_pattern;       /**< Pattern playing, NULL if none. */
+static uint8_t                   m_segment;         /**< Index of the current segment. */
+static uint16_t                  m_repeat;          /**< Plays of the pattern left, 0 for ever. */
+static uint8_t                   m_levels[APP_LED_COUNT];       /**< Brightness loaded, 0 while a pattern plays. */
+static uint8_t                   m_fade_from[APP_LED_COUNT];    /**< Brightness at the start of the fade. */
+static uint8_t                   m_fade_to[APP_LED_COUNT];      /**< Brightness at the end of the fade. */
+static uint16_t                  m_fade_steps;      /**< Number of steps of the fade, 0 if none. */
+static uint16_t                  m_fade_step;       /**< Steps of the fade loaded so far. */
+static app_led_segment_t         m_pwm_segment;     /**< Segment holding the current brightness. */
+
+
+#ifdef SOFTDEVICE_PRESENT
+static bool softdevice_enabled(void)
+{
+    uint8_t enabled;
+
+    return (sd_softdevice_is_enabled(&enabled) == NRF_SUCCESS) && (enabled != 0);
+}
+#endif
+
+
+/**@brief Function for connecting a PPI channel; the SoftDevice owns PPI while it runs. */
+static void ppi_assign(uint8_t channel, volatile uint32_t * p_event, volatile uint32_t * p_task)
+{
+#ifdef SOFTDEVICE_PRESENT
+    if (softdevice_enabled())
+    {
+        (void)sd_ppi_channel_assign(channel, p_event, p_task);
+        return;
+    }
+#endif
+    NRF_PPI->CH[channel].EEP = (uint32_t)p_event;
+    NRF_PPI->CH[channel].TEP = (uint32_t)p_task;
+}
+
+
+static void ppi_enable(uint32_t mask)
+{
+#ifdef SOFTDEVICE_PRESENT
+    if (softdevice_enabled())
+    {
+        (void)sd_ppi_channel_enable_set(mask);
+        return;
+    }
+#endif
+    NRF_PPI->CHENSET = mask;
+}
+
+
+static void ppi_disable(uint32_t mask)
+{
+#ifdef SOFTDEVICE_PRESENT
+    if (softdevice_enabled())
+    {
+        (void)sd_ppi_channel_enable_clr(mask);
+        return;
+    }
+#endif
+    NRF_PPI->CHENCLR = mask;
+}
+
+
+/**@brief Function for giving an LED to its GPIOTE channel, starting on or off.
+ *
+ * @details OUTINIT only takes effect when the channel enters task mode, so the channel is
+ *          disabled first. The GPIO output holds the same level in between, avoiding a glitch.
+ */
+static void led_attach(uint8_t led, bool lit)
+{
+    uint32_t level = (lit == m_active_high) ? 1 : 0;
+    uint8_t  ch    = APP_LED_GPIOTE_CH_FIRST + led;
+
+    nrf_gpio_pin_write(m_pins[led], level);
+    NRF_GPIOTE->CONFIG[ch] = 0;
+    NRF_GPIOTE->CONFIG[ch] = (GPIOTE_CONFIG_MODE_Task << GPIOTE_CONFIG_MODE_Pos)
+                           | ((uint32_t)m_pins[led] << GPIOTE_CONFIG_PSEL_Pos)
+                           | (GPIOTE_CONFIG_POLARITY_Toggle << GPIOTE_CONFIG_POLARITY_Pos)
+                           | (level << GPIOTE_CONFIG_OUTINIT_Pos);
+}
+
+
+/**@brief Function for handing an LED back to GPIO, switched off. */
+static void led_release(uint8_t led)
+{
+    nrf_gpio_pin_write(m_pins[led], m_active_high ? 0 : 1);
+    NRF_GPIOTE->CONFIG[APP_LED_GPIOTE_CH_FIRST + led] = 0;
+}
+
+
+/**@brief Function for setting up TIMER1, GPIOTE and PPI for a segment and starting its timer.
+ *
+ * @details The period restarts, so the new on times apply from a known pin level; changing the
+ *          compare registers of a running period could skip a toggle and invert the LED.
+ */
+static void segment_load(app_led_segment_t const * p_segment, uint8_t prescaler)
+{
+    uint32_t ppi_mask = 0;
+    uint16_t on;
+    uint8_t  led;
+
+    NRF_TIMER1->TASKS_STOP  = 1;
+    NRF_TIMER1->TASKS_CLEAR = 1;
+    NRF_TIMER1->PRESCALER   = prescaler;
+    ppi_disable(PPI_MASK_ALL);
+
+    for (led = 0; led < APP_LED_COUNT; led++)
+    {
+        on = p_segment->on[led];
+        led_attach(led, on != APP_LED_OFF);
+        if ((on != APP_LED_OFF) && (on < p_segment->period))
+        {
+            NRF_TIMER1->CC[led] = on;
+            ppi_mask           |= 3UL << (APP_LED_PPI_CH_FIRST + 2 * led);
+        }
+    }
+
+    // Steady LEDs need no timer, and so no 16 MHz clock.
+    if (ppi_mask != 0)
+    {
+        NRF_TIMER1->CC[PERIOD_CC] = p_segment->period;
+        ppi_enable(ppi_mask);
+        NRF_TIMER1->TASKS_START   = 1;
+    }
+
+    if (p_segment->duration_ms != 0)
+    {
+        (void)app_timer_start(m_segment_timer, APP_TIMER_TICKS(p_segment->duration_ms), NULL);
+    }
+}
+
+
+/**@brief Function for loading the next step of a fade.
+ *
+ * @details The hardware is only reloaded when a level changed; otherwise only the timer for the
+ *          next step is started, and the PWM runs on undisturbed.
+ */
+static void fade_step(void)
+{
+    uint8_t levels[APP_LED_COUNT];
+    uint8_t led;
+
+    m_fade_step++;
+    for (led = 0; led < APP_LED_COUNT; led++)
+    {
+        levels[led] = (uint8_t)(m_fade_from[led] +
+                                ((int32_t)(m_fade_to[led] - m_fade_from[led]) * m_fade_step) /
+                                m_fade_steps);
+    }
+
+    if ((m_fade_step == 1) || (memcmp(levels, m_levels, sizeof(levels)) != 0))
+    {
+        memcpy(m_levels, levels, sizeof(levels));
+        app_led_pwm_segment_fill(&m_pwm_segment, m_levels);
+        m_pwm_segment.duration_ms = (m_fade_step < m_fade_steps) ? APP_LED_FADE_STEP_MS : 0;
+        segment_load(&m_pwm_segment, APP_LED_PWM_PRESCALER);
+    }
+    else if (m_fade_step < m_fade_steps)
+    {
+        (void)app_timer_start(m_segment_timer, APP_TIMER_TICKS(APP_LED_FADE_STEP_MS), NULL);
+    }
+}
+
+
+/**@brief Function for moving to the next segment or fade step, from the RTC1 interrupt. */
+static void segment_timeout_handler(void * p_context)
+{
+    UNUSED_PARAMETER(p_context);
+
+    if (m_p_pattern == NULL)
+    {
+        if (m_fade_step < m_fade_steps)
+        {
+            fade_step();
+        }
+        return;
+    }
+
+    if (++m_segment == m_p_pattern->count)
+    {
+        m_segment = 0;
+        if ((m_repeat != 0) && (--m_repeat == 0))
+        {
+            app_led_stop();
+            return;
+        }
+    }
+    segment_load(&m_p_pattern->p_segments[m_segment], APP_LED_TIMER_PRESCALER);
+}
+
+
+uint32_t app_led_init(uint8_t const * p_pins, bool active_high)
+{
+    uint8_t led;
+
+    m_active_high = active_high;
+    m_p_pattern   = NULL;
+    m_fade_steps  = 0;
+    memset(m_levels, 0, sizeof(m_levels));
+
+    NRF_TIMER1->TASKS_STOP = 1;
+    NRF_TIMER1->MODE       = TIMER_MODE_MODE_Timer << TIMER_MODE_MODE_Pos;
+    NRF_TIMER1->BITMODE    = TIMER_BITMODE_BITMODE_16Bit << TIMER_BITMODE_BITMODE_Pos;
+    NRF_TIMER1->PRESCALER  = APP_LED_TIMER_PRESCALER;
+    NRF_TIMER1->SHORTS     = TIMER_SHORTS_COMPARE3_CLEAR_Msk;
+    NRF_TIMER1->INTENCLR   = 0xFFFFFFFF;
+
+    ppi_disable(PPI_MASK_ALL);
+    for (led = 0; led < APP_LED_COUNT; led++)
+    {
+        m_pins[led] = p_pins[led];
+        nrf_gpio_cfg_output(m_pins[led]);
+        led_release(led);
+
+        ppi_assign(APP_LED_PPI_CH_FIRST + 2 * led,
+                   &NRF_TIMER1->EVENTS_COMPARE[led],
+                   &NRF_GPIOTE->TASKS_OUT[APP_LED_GPIOTE_CH_FIRST + led]);
+        ppi_assign(APP_LED_PPI_CH_FIRST + 2 * led + 1,
+                   &NRF_TIMER1->EVENTS_COMPARE[PERIOD_CC],
+                   &NRF_GPIOTE->TASKS_OUT[APP_LED_GPIOTE_CH_FIRST + led]);
+    }
+
+    return app_timer_create(&m_segment_timer, APP_TIMER_MODE_SINGLE_SHOT, segment_timeout_handler);
+}
+
+
+uint32_t app_led_play(app_led_pattern_t const * p_pattern, uint16_t repeat)
+{
+    if ((p_pattern == NULL) || (p_pattern->count == 0))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    // Once stopped, the timer cannot call the handler with the old pattern.
+    (void)app_timer_stop(m_segment_timer);
+
+    m_p_pattern  = p_pattern;
+    m_segment    = 0;
+    m_repeat     = repeat;
+    m_fade_steps = 0;
+    memset(m_levels, 0, sizeof(m_levels));
+    segment_load(&p_pattern->p_segments[0], APP_LED_TIMER_PRESCALER);
+
+    return NRF_SUCCESS;
+}
+
+
+void app_led_levels_set(uint8_t const * p_levels)
+{
+    app_led_fade(p_levels, 0);
+}
+
+
+void app_led_fade(uint8_t const * p_levels, uint16_t duration_ms)
+{
+    // Once stopped, the timer cannot call the handler with the old fade or pattern.
+    (void)app_timer_stop(m_segment_timer);
+    m_p_pattern = NULL;
+
+    memcpy(m_fade_from, m_levels, sizeof(m_fade_from));
+    memcpy(m_fade_to, p_levels, sizeof(m_fade_to));
+    m_fade_steps = MAX(duration_ms / APP_LED_FADE_STEP_MS, 1);
+    m_fade_step  = 0;
+    fade_step();
+}
+
+
+void app_led_stop(void)
+{
+    uint8_t led;
+
+    (void)app_timer_stop(m_segment_timer);
+    m_p_pattern  = NULL;
+    m_fade_steps = 0;
+    memset(m_levels, 0, sizeof(m_levels));
+
+    NRF_TIMER1->TASKS_STOP = 1;
+    ppi_disable(PPI_MASK_ALL);
+    for (led = 0; led < APP_LED_COUNT; led++)
+    {
+        led_release(led);
+    }
+}
+
+
+bool app_led_is_playing(void)
+{
+    return m_p_pattern != NULL;
+}
+
+/** @} */
@@ -0,0 +1,148 @@
+/** @file
+ *
+ * @defgroup app_led LED pattern engine
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Blink, breathe and chase patterns played by TIMER1, PPI and GPIOTE.
+ *
+ * @details A pattern is a table of segments. During a segment each LED is off, on, or blinks
+ *          with the period of the segment, being on for the first part of each period:
+ *          - TIMER1 counts the period and clears itself on CC[3].
+ *          - LED n is driven by GPIOTE channel APP_LED_GPIOTE_CH_FIRST + n in toggle mode.
+ *          - PPI channels toggle LED n on TIMER1 CC[n], which ends its on time, and on CC[3],
+ *            which starts the next period.
+ *
+ *          No interrupt is raised within a segment. The CPU only runs at segment boundaries,
+ *          from the @ref app_timer interrupt, to load the next segment. TIMER1 keeps the 16 MHz
+ *          clock running while a segment blinks; it is stopped when the LEDs are steady.
+ *          A segment played until stopped runs no application timer, so the power manager
+ *          may enter System OFF during it; stop the engine in the System OFF handler.
+ *
+ *          Brightness control uses the same hardware as a segment with a short period: with
+ *          @ref app_led_levels_set and @ref app_led_fade, each LED gets an 8-bit level which is
+ *          gamma-corrected through a table into an on time out of @ref APP_LED_PWM_PERIOD
+ *          ticks at 2 MHz (244 Hz). A fade wakes the CPU every @ref APP_LED_FADE_STEP_MS to
+ *          load the next levels, never per PWM period.
+ *
+ * @note    TIMER1, GPIOTE channels APP_LED_GPIOTE_CH_FIRST to APP_LED_GPIOTE_CH_FIRST + 2 and
+ *          PPI channels APP_LED_PPI_CH_FIRST to APP_LED_PPI_CH_FIRST + 5 are owned by this
+ *          module, which is why TIMER1_ENABLED and GPIOTE_ENABLED stay 0 in nrf_drv_config.h.
+ *          Under S110 the PPI channels must be among 0 to 7. The functions must not be called
+ *          from interrupts with a priority above APP_IRQ_PRIORITY_LOW.
+ */
+
+#ifndef APP_LED_H__
+#define APP_LED_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "app_util.h"
+
+#define APP_LED_COUNT               3       /**< LEDs driven; TIMER1 CC[3] is taken by the period. */
+
+#ifndef APP_LED_GPIOTE_CH_FIRST
+#define APP_LED_GPIOTE_CH_FIRST     0       /**< First of the GPIOTE channels used. */
+#endif
+
+#ifndef APP_LED_PPI_CH_FIRST
+#define APP_LED_PPI_CH_FIRST        0       /**< First of the PPI channels used. */
+#endif
+
+#ifndef APP_LED_TIMER_PRESCALER
+#define APP_LED_TIMER_PRESCALER     9       /**< TIMER1 runs at 16 MHz / 2^9 = 31.25 kHz; a period is at most 2.09 s. */
+#endif
+
+#define APP_LED_TIMER_FREQ          (16000000UL >> APP_LED_TIMER_PRESCALER)    /**< TIMER1 frequency in Hz. */
+
+#ifndef APP_LED_PWM_PRESCALER
+#define APP_LED_PWM_PRESCALER       3       /**< TIMER1 runs at 16 MHz / 2^3 = 2 MHz for brightness control. */
+#endif
+
+#define APP_LED_PWM_PERIOD          8192    /**< PWM period in TIMER1 ticks; the gamma table is scaled to it. */
+
+#ifndef APP_LED_FADE_STEP_MS
+#define APP_LED_FADE_STEP_MS        20      /**< Time between brightness updates during a fade. */
+#endif
+
+/**@brief Converts milliseconds to TIMER1 ticks. */
+#define APP_LED_TICKS(MS)           ((uint16_t)ROUNDED_DIV((uint32_t)(MS) * APP_LED_TIMER_FREQ, 1000))
+
+#define APP_LED_OFF                 0       /**< On time of an LED which stays off. */
+#define APP_LED_ON                  0xFFFF  /**< On time of an LED which stays on. */
+
+/**@brief Pattern segment, 10 bytes. */
+typedef struct
+{
+    uint16_t duration_ms;               /**< Time the segment plays, 0 to play it until the pattern is stopped. */
+    uint16_t period;                    /**< Blink period in TIMER1 ticks, see @ref APP_LED_TICKS. */
+    uint16_t on[APP_LED_COUNT];         /**< On time of each LED in TIMER1 ticks at the start of a period, APP_LED_OFF, or at least the period to stay on. */
+} app_led_segment_t;
+
+/**@brief Pattern. */
+typedef struct
+{
+    app_led_segment_t const * p_segments;   /**< Segments, played in order. */
+    uint8_t                   count;        /**< Number of segments. */
+} app_led_pattern_t;
+
+/**@brief Function for initializing the engine. The LEDs are switched off.
+ *
+ * @param[in] p_pins       Pins of the LEDs, APP_LED_COUNT of them.
+ * @param[in] active_high  The LEDs are on when their pin is high.
+ *
+ * @retval NRF_SUCCESS  If the engine was initialized.
+ * @return Otherwise, the error returned by app_timer_create().
+ */
+uint32_t app_led_init(uint8_t const * p_pins, bool active_high);
+
+/**@brief Function for playing a pattern, replacing the one playing.
+ *
+ * @param[in] p_pattern  Pattern, which must stay valid while it plays.
+ * @param[in] repeat     Number of times the pattern is played, 0 for ever. The LEDs are
+ *                       switched off at the end.
+ *
+ * @retval NRF_SUCCESS              If the pattern started.
+ * @retval NRF_ERROR_INVALID_PARAM  If the pattern has no segments.
+ */
+uint32_t app_led_play(app_led_pattern_t const * p_pattern, uint16_t repeat);
+
+/**@brief Function for setting the brightness of the LEDs, stopping a pattern or fade.
+ *
+ * @param[in] p_levels  Level of each LED, APP_LED_COUNT of them, 0 (off) to 255 (fully on).
+ */
+void app_led_levels_set(uint8_t const * p_levels);
+
+/**@brief Function for fading the LEDs from their current brightness to new levels.
+ *
+ * @details The levels move linearly, which the gamma correction turns into an even change of
+ *          perceived brightness. A pattern playing counts as all LEDs at level 0.
+ *
+ * @param[in] p_levels     Level of each LED at the end of the fade, APP_LED_COUNT of them.
+ * @param[in] duration_ms  Duration of the fade; shorter than APP_LED_FADE_STEP_MS sets the
+ *                         levels at once.
+ */
+void app_led_fade(uint8_t const * p_levels, uint16_t duration_ms);
+
+/**@brief Function for filling in a segment which holds gamma-corrected brightness levels.
+ *
+ * @details The segment has a period of @ref APP_LED_PWM_PERIOD ticks and a duration of 0. It
+ *          is meant for TIMER1 at APP_LED_PWM_PRESCALER, as loaded by @ref app_led_levels_set.
+ *
+ * @param[out] p_segment  Segment to fill in.
+ * @param[in]  p_levels   Level of each LED, APP_LED_COUNT of them.
+ */
+void app_led_pwm_segment_fill(app_led_segment_t * p_segment, uint8_t const * p_levels);
+
+/**@brief Function for stopping the pattern playing and switching the LEDs off.
+ *
+ * @details The pins are handed back to GPIO as outputs, so LEDS_ON() and the like work again.
+ */
+void app_led_stop(void);
+
+/**@brief Function for checking whether a pattern is playing. */
+bool app_led_is_playing(void);
+
+#endif // APP_LED_H__
+
+/** @} */
@@ -0,0 +1,60 @@
+/** @file
+ *
+ * @defgroup app_led LED pattern engine
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Gamma-corrected brightness segments. Kept free of hardware access so that the host
+ *        model in host/ can check them.
+ */
+
+#include "app_led.h"
+
+STATIC_ASSERT(APP_LED_PWM_PERIOD == 8192);
+
+/**@brief On time in TIMER1 ticks for each brightness level, round(8192 * (level / 255)^2.2).
+ *
+ * @details Levels which would round to 0 get 1 tick, so that every level above 0 lights the
+ *          LED.
+ */
+static const uint16_t m_gamma[256] =
+{
+       0,    1,    1,    1,    1,    1,    2,    3,    4,    5,    7,    8,
+      10,   12,   14,   16,   19,   21,   24,   27,   30,   34,   37,   41,
+      45,   49,   54,   59,   63,   69,   74,   79,   85,   91,   97,  104,
+     110,  117,  124,  132,  139,  147,  155,  163,  172,  180,  189,  198,
+     208,  217,  227,  237,  248,  258,  269,  280,  292,  303,  315,  327,
+     340,  352,  365,  378,  391,  405,  419,  433,  447,  462,  477,  492,
+     507,  523,  539,  555,  571,  588,  605,  622,  639,  657,  675,  693,
+     712,  731,  750,  769,  789,  808,  829,  849,  870,  891,  912,  933,
+     955,  977,  999, 1022, 1045, 1068, 1091, 1115, 1139, 1163, 1188, 1212,
+    1237, 1263, 1288, 1314, 1341, 1367, 1394, 1421, 1448, 1476, 1504, 1532,
+    1560, 1589, 1618, 1647, 1677, 1707, 1737, 1768, 1798, 1829, 1861, 1892,
+    1924, 1956, 1989, 2022, 2055, 2088, 2122, 2156, 2190, 2225, 2260, 2295,
+    2330, 2366, 2402, 2438, 2475, 2512, 2549, 2587, 2625, 2663, 2701, 2740,
+    2779, 2818, 2858, 2898, 2938, 2979, 3019, 3061, 3102, 3144, 3186, 3228,
+    3271, 3314, 3357, 3401, 3445, 3489, 3534, 3578, 3624, 3669, 3715, 3761,
+    3807, 3854, 3901, 3948, 3996, 4044, 4092, 4141, 4189, 4239, 4288, 4338,
+    4388, 4438, 4489, 4540, 4592, 4643, 4695, 4748, 4800, 4853, 4907, 4960,
+    5014, 5068, 5123, 5178, 5233, 5288, 5344, 5400, 5457, 5514, 5571, 5628,
+    5686, 5744, 5802, 5861, 5920, 5979, 6039, 6099, 6160, 6220, 6281, 6342,
+    6404, 6466, 6528, 6591, 6654, 6717, 6781, 6845, 6909, 6973, 7038, 7104,
+    7169, 7235, 7301, 7368, 7435, 7502, 7569, 7637, 7705, 7774, 7843, 7912,
+    7981, 8051, 8121, 8192
+};
+
+
+void app_led_pwm_segment_fill(app_led_segment_t * p_segment, uint8_t const * p_levels)
+{
+    uint8_t led;
+
+    p_segment->duration_ms = 0;
+    p_segment->period      = APP_LED_PWM_PERIOD;
+    for (led = 0; led < APP_LED_COUNT; led++)
+    {
+        // Level 0 gives APP_LED_OFF and level 255 the whole period, which keeps the LED on.
+        p_segment->on[led] = m_gamma[p_levels[led]];
+    }
+}
+
+/** @} */
@@ -0,0 +1,169 @@
+/** @file
+ *
+ * @brief Host model of the LED brightness PWM.
+ *
+ * @details Replays what TIMER1, PPI and GPIOTE do with a segment from
+ *          app_led_pwm_segment_fill(), tick by tick: the pin starts at its OUTINIT level, is
+ *          toggled when the counter reaches CC[n], and toggled again when it reaches the period
+ *          in CC[3], which also clears the counter. It checks for every level that:
+ *          - the duty cycle is within half a tick of the gamma curve (one tick for the lowest
+ *            levels, which are raised to one tick),
+ *          - the duty cycle never decreases with the level, so fades are monotonic,
+ *          - every period starts with the pin on, i.e. no toggle is lost, also when the segment
+ *            is reloaded in the middle of a period as a fade does.
+ *
+ *          Exits with 1 if a check fails.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "app_led.h"
+
+#define GAMMA           2.2         /**< Gamma the table was computed with. */
+#define PERIODS         3           /**< Periods simulated per level. */
+#define PWM_FREQ        (16000000.0 / (1 << APP_LED_PWM_PRESCALER) / APP_LED_PWM_PERIOD)
+
+static bool m_verbose;
+
+
+/**@brief Function for simulating one LED from a segment load for a number of ticks.
+ *
+ * @param[in]  on            On time from the segment.
+ * @param[in]  period        Period from the segment.
+ * @param[in]  ticks         Ticks to simulate.
+ * @param[out] p_bad_start   Set if a period did not start with the pin on.
+ *
+ * @return Ticks the pin was on.
+ */
+static uint32_t led_simulate(uint16_t on, uint16_t period, uint32_t ticks, bool * p_bad_start)
+{
+    bool     toggling = (on != APP_LED_OFF) && (on < period);
+    bool     pin      = (on != APP_LED_OFF);    // OUTINIT
+    uint32_t counter  = 0;
+    uint32_t high     = 0;
+    uint32_t tick;
+
+    for (tick = 0; tick < ticks; tick++)
+    {
+        if ((counter == 0) && toggling && !pin)
+        {
+            *p_bad_start = true;
+        }
+        high += pin ? 1 : 0;
+
+        counter++;
+        if (toggling && (counter == on))
+        {
+            pin = !pin;                         // CC[n] -> PPI -> GPIOTE OUT[n]
+        }
+        if (counter == period)
+        {
+            counter = 0;                        // COMPARE3_CLEAR short
+            if (toggling)
+            {
+                pin = !pin;                     // CC[3] -> PPI -> GPIOTE OUT[n]
+            }
+        }
+    }
+
+    return high;
+}
+
+
+/**@brief Function for checking one level on all LEDs.
+ *
+ * @param[in]    level        Level to check.
+ * @param[inout] p_prev_duty  Duty cycle of the previous level, updated.
+ * @param[inout] p_max_error  Largest error seen in ticks, updated.
+ *
+ * @return Number of failed checks.
+ */
+static uint32_t level_check(uint8_t level, double * p_prev_duty, double * p_max_error)
+{
+    uint8_t           levels[APP_LED_COUNT];
+    app_led_segment_t segment;
+    uint32_t          failures = 0;
+    uint32_t          high;
+    uint32_t          reload;
+    bool              bad_start = false;
+    double            duty;
+    double            target;
+    double            error;
+    double            allowed;
+    uint8_t           led;
+
+    memset(levels, level, sizeof(levels));
+    app_led_pwm_segment_fill(&segment, levels);
+
+    target  = pow(level / 255.0, GAMMA);
+    allowed = (segment.on[0] == 1) ? 1.0 : 0.5;
+
+    for (led = 0; led < APP_LED_COUNT; led++)
+    {
+        high  = led_simulate(segment.on[led], segment.period, PERIODS * segment.period, &bad_start);
+        duty  = (double)high / (PERIODS * segment.period);
+        error = fabs(duty - target) * segment.period;
+        if (error > *p_max_error)
+        {
+            *p_max_error = error;
+        }
+        if (error > allowed)
+        {
+            printf("level %3u led %u: duty %.6f, gamma %.6f, off by %.2f ticks\n",
+                   level, led, duty, target, error);
+            failures++;
+        }
+    }
+
+    if (duty < *p_prev_duty)
+    {
+        printf("level %3u: duty %.6f below level %u\n", level, duty, level - 1);
+        failures++;
+    }
+    *p_prev_duty = duty;
+
+    // A fade reloads the segment at any point of a period; the next period must start lit.
+    for (reload = 1; reload < segment.period; reload += 997)
+    {
+        (void)led_simulate(segment.on[0], segment.period, reload, &bad_start);
+        (void)led_simulate(segment.on[0], segment.period, 2 * segment.period, &bad_start);
+    }
+    if (bad_start)
+    {
+        printf("level %3u: a period started with the LED off\n", level);
+        failures++;
+    }
+
+    if (m_verbose)
+    {
+        printf("level %3u: on %4u/%u, duty %.6f, gamma %.6f\n",
+               level, segment.on[0], segment.period, duty, target);
+    }
+
+    return failures;
+}
+
+
+int main(int argc, char ** argv)
+{
+    uint32_t failures  = 0;
+    double   prev_duty = 0;
+    double   max_error = 0;
+    uint32_t level;
+
+    m_verbose = (argc > 1) && (strcmp(argv[1], "-v") == 0);
+
+    for (level = 0; level < 256; level++)
+    {
+        failures += level_check((uint8_t)level, &prev_duty, &max_error);
+    }
+
+    printf("PWM %u ticks at %u Hz, %.1f Hz; largest duty error %.2f ticks (%.4f%%); %u failures\n",
+           APP_LED_PWM_PERIOD, 16000000U >> APP_LED_PWM_PRESCALER, PWM_FREQ,
+           max_error, 100.0 * max_error / APP_LED_PWM_PERIOD, failures);
+
+    return (failures == 0) ? 0 : 1;
+}
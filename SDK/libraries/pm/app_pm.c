@@ -0,0 +1,254 @@
+/** @file
+ *
+ * @defgroup app_pm Power manager
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Tickless idle: sleeps as deeply as the pending work allows.
+ */
+
+#include "app_pm.h"
+#include <stddef.h>
+#include <string.h>
+#include "nrf.h"
+#include "nrf_error.h"
+#include "nrf_gpio.h"
+#include "app_scheduler.h"
+#include "app_timer.h"
+#ifdef SOFTDEVICE_PRESENT
+#include "nrf_sdm.h"
+#include "nrf_soc.h"
+#endif
+
+static app_pm_sysoff_handler_t m_sysoff_handler;    /**< Called before System OFF. */
+static uint32_t                m_wakeup_pins;       /**< Pins waking the chip from System OFF. */
+static uint32_t                m_hfclk_requests;    /**< Number of pending crystal requests. */
+static bool                    m_woke_from_off;     /**< Last reset was a wakeup from System OFF. */
+static uint32_t                m_mark;              /**< RTC1 counter at the last state change. */
+static app_pm_stats_t          m_stats;             /**< Statistics since the last reset. */
+
+
+static bool softdevice_enabled(void)
+{
+#ifdef SOFTDEVICE_PRESENT
+    uint8_t enabled;
+
+    return (sd_softdevice_is_enabled(&enabled) == NRF_SUCCESS) && (enabled != 0);
+#else
+    return false;
+#endif
+}
+
+
+/**@brief Function for adding the time since the last state change to a state.
+ */
+static void ticks_account(app_pm_state_t state)
+{
+    uint32_t now;
+    uint32_t diff;
+
+    (void)app_timer_cnt_get(&now);
+    (void)app_timer_cnt_diff_compute(now, m_mark, &diff);
+    m_stats.ticks[state] += diff;
+    m_mark                = now;
+}
+
+
+static void hfclk_start(void)
+{
+    if (softdevice_enabled())
+    {
+#ifdef SOFTDEVICE_PRESENT
+        (void)sd_clock_hfclk_request();
+#endif
+        return;
+    }
+    NRF_CLOCK->EVENTS_HFCLKSTARTED = 0;
+    NRF_CLOCK->TASKS_HFCLKSTART    = 1;
+}
+
+
+static void hfclk_stop(void)
+{
+    if (softdevice_enabled())
+    {
+#ifdef SOFTDEVICE_PRESENT
+        (void)sd_clock_hfclk_release();
+#endif
+        return;
+    }
+    NRF_CLOCK->TASKS_HFCLKSTOP = 1;
+}
+
+
+/**@brief Function for putting the CPU to sleep until an interrupt occurs.
+ *
+ * @details Interrupts are masked while the queue is checked, so an event put after the check
+ *          keeps its interrupt pending, which wakes WFE through SEVONPEND. The handler runs
+ *          once interrupts are unmasked. A stale event register only causes one extra pass
+ *          through the main loop.
+ */
+static void cpu_sleep(void)
+{
+    if (softdevice_enabled())
+    {
+#ifdef SOFTDEVICE_PRESENT
+        (void)sd_app_evt_wait();
+#endif
+        return;
+    }
+
+    __disable_irq();
+    if (app_sched_queue_is_empty())
+    {
+        __WFE();
+    }
+    __enable_irq();
+}
+
+
+uint32_t app_pm_init(app_pm_sysoff_handler_t sysoff_handler)
+{
+    m_sysoff_handler = sysoff_handler;
+    m_wakeup_pins    = 0;
+    m_hfclk_requests = 0;
+
+    // Only this bit is cleared, so that other modules still see why the chip was reset.
+    m_woke_from_off = (NRF_POWER->RESETREAS & POWER_RESETREAS_OFF_Msk) != 0;
+    if (m_woke_from_off)
+    {
+        NRF_POWER->RESETREAS = POWER_RESETREAS_OFF_Msk;
+    }
+
+    // Let interrupts which are masked or disabled wake WFE.
+    SCB->SCR |= SCB_SCR_SEVONPEND_Msk;
+
+    app_pm_stats_reset();
+
+    return NRF_SUCCESS;
+}
+
+
+void app_pm_wakeup_pins_set(uint32_t pin_mask)
+{
+    m_wakeup_pins = pin_mask;
+}
+
+
+bool app_pm_woke_from_off(void)
+{
+    return m_woke_from_off;
+}
+
+
+void app_pm_hfclk_request(void)
+{
+    if (m_hfclk_requests++ == 0)
+    {
+        hfclk_start();
+    }
+}
+
+
+void app_pm_hfclk_release(void)
+{
+    if ((m_hfclk_requests != 0) && (--m_hfclk_requests == 0))
+    {
+        hfclk_stop();
+    }
+}
+
+
+void app_pm_sleep(void)
+{
+    app_pm_state_t state;
+    uint32_t       ticks_to_wakeup;
+    bool           timer_pending;
+
+    timer_pending = (app_timer_next_expiry_get(&ticks_to_wakeup) == NRF_SUCCESS);
+
+    // Nothing is due on RTC1; only a pin or a reset can bring new work.
+    if (!timer_pending && (m_wakeup_pins != 0) && app_sched_queue_is_empty())
+    {
+        app_pm_system_off();
+    }
+
+    state = APP_PM_STATE_IDLE;
+    if (m_hfclk_requests != 0)
+    {
+        if (timer_pending && (ticks_to_wakeup <= APP_PM_HFCLK_KEEP_TICKS))
+        {
+            state = APP_PM_STATE_IDLE_HFCLK;
+        }
+        else
+        {
+            hfclk_stop();
+        }
+    }
+
+    ticks_account(APP_PM_STATE_ACTIVE);
+    m_stats.entries[state]++;
+
+    cpu_sleep();
+
+    ticks_account(state);
+    m_stats.entries[APP_PM_STATE_ACTIVE]++;
+
+    if ((state == APP_PM_STATE_IDLE) && (m_hfclk_requests != 0))
+    {
+        hfclk_start();
+    }
+}
+
+
+void app_pm_system_off(void)
+{
+    uint32_t pin;
+
+    if (m_sysoff_handler != NULL)
+    {
+        m_sysoff_handler();
+    }
+
+    // A button held down, e.g. in a bag, would wake the chip at once if it sensed low; it wakes
+    // the chip when released instead, and the next System OFF senses low again.
+    for (pin = 0; pin < 32; pin++)
+    {
+        if ((m_wakeup_pins & (1UL << pin)) != 0)
+        {
+            nrf_gpio_cfg_sense_input(pin, NRF_GPIO_PIN_PULLUP, NRF_GPIO_PIN_NOSENSE);
+            nrf_gpio_cfg_sense_set(pin, nrf_gpio_pin_read(pin) ?
+                                        NRF_GPIO_PIN_SENSE_LOW : NRF_GPIO_PIN_SENSE_HIGH);
+        }
+    }
+
+#ifdef SOFTDEVICE_PRESENT
+    if (softdevice_enabled())
+    {
+        (void)sd_power_system_off();
+    }
+#endif
+    NRF_POWER->SYSTEMOFF = 1;
+
+    // Under a debugger System OFF is only emulated and the CPU keeps running.
+    for (;;)
+    {
+        __WFE();
+    }
+}
+
+
+void app_pm_stats_get(app_pm_stats_t * p_stats)
+{
+    ticks_account(APP_PM_STATE_ACTIVE);
+    *p_stats = m_stats;
+}
+
+
+void app_pm_stats_reset(void)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+    (void)app_timer_cnt_get(&m_mark);
+}
+
+/** @} */
@@ -0,0 +1,111 @@
+/** @file
+ *
+ * @defgroup app_pm Power manager
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Tickless idle: sleeps as deeply as the pending work allows.
+ *
+ * @details @ref app_pm_sleep is called from the main loop whenever the scheduler queue is empty.
+ *          There is no periodic tick; the next wakeup is the nearest application timer expiry
+ *          (see @ref app_timer_next_expiry_get) or any interrupt. The power manager picks:
+ *          - System OFF, if no timer is running and wakeup pins were set with
+ *            @ref app_pm_wakeup_pins_set. RAM is lost and a wakeup pin resets the chip.
+ *          - System ON idle otherwise: WFE, or sd_app_evt_wait() with the SoftDevice enabled. If
+ *            the 16 MHz crystal was requested with @ref app_pm_hfclk_request and the next expiry
+ *            is further away than @ref APP_PM_HFCLK_KEEP_TICKS, the crystal is released for the
+ *            sleep (sd_clock_hfclk_release() under S110) and requested again on wakeup.
+ *
+ *          The time spent in each state is measured with the RTC1 counter, see
+ *          @ref app_pm_stats_get.
+ *
+ * @note    The scheduler and the timer module must be initialized before this module. The
+ *          functions must be called from thread mode only.
+ */
+
+#ifndef APP_PM_H__
+#define APP_PM_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef APP_PM_HFCLK_KEEP_TICKS
+#define APP_PM_HFCLK_KEEP_TICKS     33  /**< Shorter sleeps keep the crystal running; restarting it takes about 1 ms. */
+#endif
+
+/**@brief Power states. */
+typedef enum
+{
+    APP_PM_STATE_ACTIVE,        /**< CPU running, including interrupt handlers. */
+    APP_PM_STATE_IDLE_HFCLK,    /**< System ON sleep with the 16 MHz crystal kept running. */
+    APP_PM_STATE_IDLE,          /**< System ON sleep with the 16 MHz crystal released. */
+    APP_PM_STATE_COUNT
+} app_pm_state_t;
+
+/**@brief Power manager statistics. */
+typedef struct
+{
+    uint32_t ticks[APP_PM_STATE_COUNT];     /**< RTC1 ticks spent in each state. */
+    uint32_t entries[APP_PM_STATE_COUNT];   /**< Number of times each state was entered. */
+} app_pm_stats_t;
+
+/**@brief Handler called just before System OFF, e.g. to switch LEDs off. */
+typedef void (*app_pm_sysoff_handler_t)(void);
+
+/**@brief Function for initializing the power manager.
+ *
+ * @param[in] sysoff_handler  Handler called before System OFF, or NULL.
+ *
+ * @retval NRF_SUCCESS  If the power manager was initialized.
+ */
+uint32_t app_pm_init(app_pm_sysoff_handler_t sysoff_handler);
+
+/**@brief Function for selecting the pins which wake the chip from System OFF.
+ *
+ * @details The pins are configured as inputs with pull-up, sensing low, when System OFF is
+ *          entered, which suits active-low buttons. A pin which is low already senses high, so
+ *          that a button held down wakes the chip on release rather than at once.
+ *
+ * @param[in] pin_mask  Wakeup pins, 0 to never enter System OFF automatically.
+ */
+void app_pm_wakeup_pins_set(uint32_t pin_mask);
+
+/**@brief Function for checking whether the last reset was a wakeup from System OFF.
+ */
+bool app_pm_woke_from_off(void);
+
+/**@brief Function for requesting the 16 MHz crystal oscillator.
+ *
+ * @details Requests are counted. The crystal is only released for sleeps longer than
+ *          @ref APP_PM_HFCLK_KEEP_TICKS while requests are pending.
+ */
+void app_pm_hfclk_request(void);
+
+/**@brief Function for releasing a request for the 16 MHz crystal oscillator.
+ */
+void app_pm_hfclk_release(void);
+
+/**@brief Function for sleeping until the next event. Call when the scheduler queue is empty.
+ *
+ * @details Returns after the CPU has woken up; does not return if System OFF is entered.
+ */
+void app_pm_sleep(void);
+
+/**@brief Function for entering System OFF now. Does not return.
+ *
+ * @details Enters System OFF even if timers are running; they are lost.
+ */
+void app_pm_system_off(void);
+
+/**@brief Function for getting the statistics gathered since the last reset.
+ *
+ * @param[out] p_stats  Statistics. The current state is accounted up to this call.
+ */
+void app_pm_stats_get(app_pm_stats_t * p_stats);
+
+/**@brief Function for resetting the statistics. */
+void app_pm_stats_reset(void);
+
+#endif // APP_PM_H__
+
+/** @} */
@@ -0,0 +1,262 @@
+/** @file
+ *
+ * @defgroup app_pool Fixed-block pool allocator
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Blocks of a few fixed sizes, allocated and freed in constant time, also from interrupts.
+ */
+
+#include "app_pool.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "nrf_error.h"
+#include "nordic_common.h"
+#include "app_util.h"
+#include "app_util_platform.h"
+#include "compiler_abstraction.h"
+
+#define HEADER_USED     0xB10C5E00UL    /**< Header of an allocated block, with the pool in the low byte. */
+#define HEADER_FREE     0xF4EEB10CUL    /**< Header of a free block. */
+#define GUARD           0xDEADBEEFUL    /**< Guard word after a block. */
+
+/**@brief Words of a block: header, data and guard. Word 1 links free blocks. */
+#define BLOCK_WORDS(SIZE)   (1 + CEIL_DIV(SIZE, sizeof(uint32_t)) + APP_POOL_GUARD_ENABLED)
+
+STATIC_ASSERT((APP_POOL0_BLOCK_SIZE > 0) && (APP_POOL0_BLOCK_SIZE < APP_POOL1_BLOCK_SIZE) &&
+              (APP_POOL1_BLOCK_SIZE < APP_POOL2_BLOCK_SIZE) && (APP_POOL2_BLOCK_SIZE <= 0xFFFF));
+STATIC_ASSERT((APP_POOL0_BLOCKS > 0) && (APP_POOL1_BLOCKS > 0) && (APP_POOL2_BLOCKS > 0));
+
+/**@brief Memory of all pools. */
+typedef struct
+{
+    uint32_t pool0[APP_POOL0_BLOCKS][BLOCK_WORDS(APP_POOL0_BLOCK_SIZE)];
+    uint32_t pool1[APP_POOL1_BLOCKS][BLOCK_WORDS(APP_POOL1_BLOCK_SIZE)];
+    uint32_t pool2[APP_POOL2_BLOCKS][BLOCK_WORDS(APP_POOL2_BLOCK_SIZE)];
+} pool_memory_t;
+
+/**@brief Layout of a pool. */
+typedef struct
+{
+    uint32_t * p_start;         /**< First block. */
+    uint16_t   block_words;     /**< Words per block, header and guard included. */
+    uint16_t   block_size;      /**< Bytes usable per block. */
+    uint16_t   blocks;          /**< Number of blocks. */
+} pool_layout_t;
+
+static __NOINIT pool_memory_t m_memory;                     /**< Blocks of all pools; app_pool_init() writes every header, so the startup code need not zero them. */
+static const pool_layout_t m_layouts[APP_POOL_COUNT] =
+{
+    {&m_memory.pool0[0][0], BLOCK_WORDS(APP_POOL0_BLOCK_SIZE), APP_POOL0_BLOCK_SIZE, APP_POOL0_BLOCKS},
+    {&m_memory.pool1[0][0], BLOCK_WORDS(APP_POOL1_BLOCK_SIZE), APP_POOL1_BLOCK_SIZE, APP_POOL1_BLOCKS},
+    {&m_memory.pool2[0][0], BLOCK_WORDS(APP_POOL2_BLOCK_SIZE), APP_POOL2_BLOCK_SIZE, APP_POOL2_BLOCKS},
+};
+static uint32_t *          m_p_free[APP_POOL_COUNT];        /**< Free list of each pool, linked through word 1. */
+static app_pool_stats_t    m_stats[APP_POOL_COUNT];         /**< Usage of each pool. */
+static __NOINIT uint32_t   m_sbrk_arena[CEIL_DIV(APP_POOL_SBRK_SIZE, sizeof(uint32_t))]; /**< Heap handed out by _sbrk. */
+static uint32_t            m_sbrk_used;                     /**< Bytes of m_sbrk_arena handed out. */
+
+
+/**@brief Function for finding the pool a block lies in, checking that it starts a block.
+ *
+ * @return Pool, or APP_POOL_COUNT if p_block is not the header of a block.
+ */
+static uint8_t pool_find(uint32_t const * p_block)
+{
+    pool_layout_t const * p_layout;
+    uint32_t              offset;
+    uint8_t               pool;
+
+    for (pool = 0; pool < APP_POOL_COUNT; pool++)
+    {
+        p_layout = &m_layouts[pool];
+        if ((p_block >= p_layout->p_start) &&
+            (p_block < p_layout->p_start + p_layout->blocks * p_layout->block_words))
+        {
+            offset = (uint32_t)(p_block - p_layout->p_start);
+            return ((offset % p_layout->block_words) == 0) ? pool : APP_POOL_COUNT;
+        }
+    }
+    return APP_POOL_COUNT;
+}
+
+
+static bool guard_is_intact(uint32_t const * p_block, uint8_t pool)
+{
+    return (APP_POOL_GUARD_ENABLED == 0) || (p_block[m_layouts[pool].block_words - 1] == GUARD);
+}
+
+
+void app_pool_init(void)
+{
+    pool_layout_t const * p_layout;
+    uint32_t *            p_block;
+    uint8_t               pool;
+    uint16_t              i;
+
+    for (pool = 0; pool < APP_POOL_COUNT; pool++)
+    {
+        p_layout       = &m_layouts[pool];
+        m_p_free[pool] = NULL;
+
+        // Linked from the last block down, so the first block is handed out first.
+        for (i = p_layout->blocks; i > 0; i--)
+        {
+            p_block        = p_layout->p_start + (i - 1) * p_layout->block_words;
+            p_block[0]     = HEADER_FREE;
+            p_block[1]     = (uint32_t)m_p_free[pool];
+            m_p_free[pool] = p_block;
+        }
+
+        m_stats[pool].block_size = p_layout->block_size;
+        m_stats[pool].blocks     = p_layout->blocks;
+        m_stats[pool].used       = 0;
+        m_stats[pool].used_max   = 0;
+        m_stats[pool].allocs     = 0;
+        m_stats[pool].failed     = 0;
+    }
+}
+
+
+void * app_pool_alloc(uint16_t size)
+{
+    uint32_t * p_block = NULL;
+    uint8_t    first   = APP_POOL_COUNT;
+    uint8_t    pool;
+
+    for (pool = 0; (pool < APP_POOL_COUNT) && (p_block == NULL); pool++)
+    {
+        if (size > m_layouts[pool].block_size)
+        {
+            continue;
+        }
+        if (first == APP_POOL_COUNT)
+        {
+            first = pool;
+        }
+
+        CRITICAL_REGION_ENTER();
+        p_block = m_p_free[pool];
+        if (p_block != NULL)
+        {
+            m_p_free[pool] = (uint32_t *)p_block[1];
+            p_block[0]     = HEADER_USED | pool;
+            m_stats[pool].allocs++;
+            if (++m_stats[pool].used > m_stats[pool].used_max)
+            {
+                m_stats[pool].used_max = m_stats[pool].used;
+            }
+        }
+        CRITICAL_REGION_EXIT();
+
+        if ((p_block != NULL) && (APP_POOL_GUARD_ENABLED != 0))
+        {
+            p_block[m_layouts[pool].block_words - 1] = GUARD;
+        }
+    }
+
+    if (p_block == NULL)
+    {
+        if (first < APP_POOL_COUNT)
+        {
+            CRITICAL_REGION_ENTER();
+            m_stats[first].failed++;
+            CRITICAL_REGION_EXIT();
+        }
+        return NULL;
+    }
+    return &p_block[1];
+}
+
+
+uint32_t app_pool_free(void * p_block)
+{
+    uint32_t * p_header = (uint32_t *)p_block - 1;
+    uint32_t   err_code = NRF_ERROR_INVALID_ADDR;
+    uint8_t    pool     = pool_find(p_header);
+    bool       intact;
+
+    if (pool == APP_POOL_COUNT)
+    {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+    intact = guard_is_intact(p_header, pool);
+
+    CRITICAL_REGION_ENTER();
+    // Checked inside the region, so two racing frees of one block cannot both succeed.
+    if (p_header[0] == (HEADER_USED | pool))
+    {
+        p_header[0]    = HEADER_FREE;
+        p_header[1]    = (uint32_t)m_p_free[pool];
+        m_p_free[pool] = p_header;
+        m_stats[pool].used--;
+        err_code       = intact ? NRF_SUCCESS : NRF_ERROR_INVALID_DATA;
+    }
+    CRITICAL_REGION_EXIT();
+
+    return err_code;
+}
+
+
+uint32_t app_pool_check(void)
+{
+    pool_layout_t const * p_layout;
+    uint32_t const *      p_block;
+    uint8_t               pool;
+    uint16_t              i;
+
+    for (pool = 0; pool < APP_POOL_COUNT; pool++)
+    {
+        p_layout = &m_layouts[pool];
+        for (i = 0; i < p_layout->blocks; i++)
+        {
+            p_block = p_layout->p_start + i * p_layout->block_words;
+            if ((p_block[0] == (HEADER_USED | pool)) && !guard_is_intact(p_block, pool))
+            {
+                return NRF_ERROR_INVALID_DATA;
+            }
+        }
+    }
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_pool_stats_get(uint8_t pool, app_pool_stats_t * p_stats)
+{
+    if (pool >= APP_POOL_COUNT)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    CRITICAL_REGION_ENTER();
+    *p_stats = m_stats[pool];
+    CRITICAL_REGION_EXIT();
+
+    return NRF_SUCCESS;
+}
+
+
+/**@brief newlib heap growth, bounded by a static arena: malloc() returns NULL past it.
+ *
+ * @details Overrides the _sbrk of libnosys, which grows the heap from the end of .bss without
+ *          checking it against the stack. Only newlib itself is expected to allocate, for the
+ *          stdio FILE structures, and only from thread mode.
+ */
+void * _sbrk(ptrdiff_t incr)
+{
+    uint8_t * p_break = (uint8_t *)m_sbrk_arena + m_sbrk_used;
+
+    if ((incr > (ptrdiff_t)(sizeof(m_sbrk_arena) - m_sbrk_used)) ||
+        (incr < -(ptrdiff_t)m_sbrk_used))
+    {
+        errno = ENOMEM;
+        return (void *)-1;
+    }
+
+    m_sbrk_used += incr;
+
+    return p_break;
+}
+
+/** @} */
@@ -0,0 +1,119 @@
+/** @file
+ *
+ * @defgroup app_pool Fixed-block pool allocator
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Blocks of a few fixed sizes, allocated and freed in constant time, also from interrupts.
+ *
+ * @details Each of the @ref APP_POOL_COUNT pools holds a number of blocks of one size, set at
+ *          compile time with APP_POOLn_BLOCK_SIZE and APP_POOLn_BLOCKS. @ref app_pool_alloc takes
+ *          a block from the smallest pool whose blocks are large enough and which has one free,
+ *          so a request can spill over to a larger size but never fragments memory. Alloc and
+ *          free unlink or link one block of a free list inside a critical region; their time does
+ *          not depend on how many blocks are in use.
+ *
+ *          Every block starts with a header word naming its pool, which lets
+ *          @ref app_pool_free catch pointers that are not allocated blocks and blocks freed
+ *          twice. With APP_POOL_GUARD_ENABLED, a guard word after each block catches writes past
+ *          its end, when the block is freed or by @ref app_pool_check.
+ *
+ *          The module also replaces the newlib _sbrk with one which grows the heap inside a
+ *          static arena of APP_POOL_SBRK_SIZE bytes and fails past it, so that malloc() returns
+ *          NULL instead of taking RAM from the stack; the startup code reserves no heap
+ *          (__HEAP_SIZE=0). newlib-nano still needs the arena: the first use of stdio allocates
+ *          the stdin, stdout and stderr FILE structures with malloc().
+ */
+
+#ifndef APP_POOL_H__
+#define APP_POOL_H__
+
+#include <stdint.h>
+
+#define APP_POOL_COUNT          3       /**< Number of pools. */
+
+#ifndef APP_POOL0_BLOCK_SIZE
+#define APP_POOL0_BLOCK_SIZE    16      /**< Bytes per block of pool 0, the smallest. */
+#endif
+
+#ifndef APP_POOL0_BLOCKS
+#define APP_POOL0_BLOCKS        8       /**< Blocks in pool 0. */
+#endif
+
+#ifndef APP_POOL1_BLOCK_SIZE
+#define APP_POOL1_BLOCK_SIZE    64      /**< Bytes per block of pool 1. */
+#endif
+
+#ifndef APP_POOL1_BLOCKS
+#define APP_POOL1_BLOCKS        4       /**< Blocks in pool 1. */
+#endif
+
+#ifndef APP_POOL2_BLOCK_SIZE
+#define APP_POOL2_BLOCK_SIZE    128     /**< Bytes per block of pool 2, the largest. */
+#endif
+
+#ifndef APP_POOL2_BLOCKS
+#define APP_POOL2_BLOCKS        2       /**< Blocks in pool 2. */
+#endif
+
+#ifndef APP_POOL_SBRK_SIZE
+#define APP_POOL_SBRK_SIZE      512     /**< Bytes newlib may take for its own malloc() calls. */
+#endif
+
+#ifndef APP_POOL_GUARD_ENABLED
+#define APP_POOL_GUARD_ENABLED  1       /**< Add a guard word after every block, 4 bytes each. */
+#endif
+
+/**@brief Usage of a pool. */
+typedef struct
+{
+    uint16_t block_size;        /**< Bytes per block. */
+    uint16_t blocks;            /**< Blocks in the pool. */
+    uint16_t used;              /**< Blocks allocated now. */
+    uint16_t used_max;          /**< Most blocks allocated at once since init. */
+    uint32_t allocs;            /**< Blocks allocated since init. */
+    uint32_t failed;            /**< Requests this pool was the first fit for which got no block. */
+} app_pool_stats_t;
+
+/**@brief Function for initializing the pools, with all blocks free. */
+void app_pool_init(void);
+
+/**@brief Function for allocating a block.
+ *
+ * @param[in] size  Bytes needed.
+ *
+ * @return Word-aligned block of at least size bytes, or NULL if none is free.
+ */
+void * app_pool_alloc(uint16_t size);
+
+/**@brief Function for freeing a block.
+ *
+ * @param[in] p_block  Block from @ref app_pool_alloc.
+ *
+ * @retval NRF_SUCCESS             If the block was freed.
+ * @retval NRF_ERROR_INVALID_ADDR  If p_block is not an allocated block; nothing is freed.
+ * @retval NRF_ERROR_INVALID_DATA  If the guard word after the block was overwritten; the block
+ *                                 is freed nonetheless.
+ */
+uint32_t app_pool_free(void * p_block);
+
+/**@brief Function for checking the guard words of all allocated blocks.
+ *
+ * @retval NRF_SUCCESS             If all are intact, or APP_POOL_GUARD_ENABLED is 0.
+ * @retval NRF_ERROR_INVALID_DATA  If a block was written past its end.
+ */
+uint32_t app_pool_check(void);
+
+/**@brief Function for getting the usage of a pool.
+ *
+ * @param[in]  pool     Pool, 0 to APP_POOL_COUNT - 1.
+ * @param[out] p_stats  Usage.
+ *
+ * @retval NRF_SUCCESS              If p_stats was filled in.
+ * @retval NRF_ERROR_INVALID_PARAM  If pool is out of range.
+ */
+uint32_t app_pool_stats_get(uint8_t pool, app_pool_stats_t * p_stats);
+
+#endif // APP_POOL_H__
+
+/** @} */
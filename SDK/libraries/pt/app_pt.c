@@ -0,0 +1,250 @@
+/** @file
+ *
+ * @defgroup app_pt Protothreads
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Stackless cooperative tasks run from the main loop.
+ */
+
+#include "app_pt.h"
+#include <stddef.h>
+#include "nrf_error.h"
+#include "app_util_platform.h"
+#include "app_scheduler.h"
+#include "app_timer.h"
+
+#define RTC_COUNTER_MASK    0x00FFFFFF      /**< Deadlines are RTC1 counter values, 24 bits wide. */
+#define RTC_COUNTER_HALF    0x00800000      /**< Deadlines this far behind the counter have passed. */
+
+APP_TIMER_DEF(m_pt_timer);                  /**< Single-shot timer for the nearest deadline. */
+static app_pt_t *    m_p_head;              /**< Running tasks, most recently started first. */
+static volatile bool m_run_pending;         /**< A pass is queued in the scheduler. */
+
+static void run_request(void);
+
+
+/**@brief Function for getting the ticks until a deadline, 0 if it has passed. */
+static uint32_t deadline_ahead(uint32_t deadline, uint32_t now)
+{
+    uint32_t ahead = (deadline - now) & RTC_COUNTER_MASK;
+
+    return (ahead < RTC_COUNTER_HALF) ? ahead : 0;
+}
+
+
+/**@brief Function for running every ready task once, in thread mode.
+ *
+ * @details A task is ready when an event it waits for was posted, its deadline has passed or it
+ *          yielded. After the pass, another pass is queued if a task yielded, and the timer is
+ *          set for the nearest deadline otherwise.
+ */
+static void run_evt_handler(void * p_event_data, uint16_t event_size)
+{
+    app_pt_t ** pp_link = &m_p_head;
+    app_pt_t *  p_pt;
+    uint32_t    now;
+    uint32_t    ahead;
+    uint32_t    nearest = RTC_COUNTER_HALF;
+    bool        again   = false;
+
+    UNUSED_PARAMETER(p_event_data);
+    UNUSED_PARAMETER(event_size);
+
+    // Posts from here on queue a new pass.
+    m_run_pending = false;
+
+    (void)app_timer_cnt_get(&now);
+    while ((p_pt = *pp_link) != NULL)
+    {
+        if (p_pt->timed && (deadline_ahead(p_pt->deadline, now) == 0))
+        {
+            p_pt->ready = 1;
+        }
+        if (p_pt->ready)
+        {
+            // Cleared before the call: a post after this point sets it again.
+            p_pt->ready = 0;
+            switch (p_pt->thread(p_pt))
+            {
+                case APP_PT_EXITED:
+                    *pp_link     = p_pt->p_next;
+                    p_pt->thread = NULL;
+                    continue;
+
+                case APP_PT_YIELDED:
+                    p_pt->ready = 1;
+                    break;
+
+                default:
+                    break;
+            }
+        }
+        pp_link = &p_pt->p_next;
+    }
+
+    (void)app_timer_cnt_get(&now);
+    for (p_pt = m_p_head; p_pt != NULL; p_pt = p_pt->p_next)
+    {
+        if (p_pt->ready)
+        {
+            again = true;
+        }
+        else if (p_pt->timed)
+        {
+            ahead   = deadline_ahead(p_pt->deadline, now);
+            nearest = MIN(nearest, ahead);
+        }
+    }
+
+    if (again || (nearest == 0))
+    {
+        run_request();
+    }
+    else if (nearest < RTC_COUNTER_HALF)
+    {
+        (void)app_timer_start(m_pt_timer, nearest, NULL);
+    }
+    else
+    {
+        // Only events can wake the tasks; leave RTC1 idle.
+        (void)app_timer_stop(m_pt_timer);
+    }
+}
+
+
+/**@brief Function for queuing a pass, unless one is queued already.
+ *
+ * @details If the scheduler queue is full, the pass is retried from the timer one tick later.
+ */
+static void run_request(void)
+{
+    bool put = false;
+
+    CRITICAL_REGION_ENTER();
+    if (!m_run_pending)
+    {
+        m_run_pending = true;
+        put           = true;
+    }
+    CRITICAL_REGION_EXIT();
+
+    if (put && (app_sched_event_put(NULL, 0, run_evt_handler) != NRF_SUCCESS))
+    {
+        m_run_pending = false;
+        (void)app_timer_start(m_pt_timer, 1, NULL);
+    }
+}
+
+
+static void pt_timeout_handler(void * p_context)
+{
+    UNUSED_PARAMETER(p_context);
+
+    run_request();
+}
+
+
+uint32_t app_pt_init(void)
+{
+    m_p_head      = NULL;
+    m_run_pending = false;
+
+    return app_timer_create(&m_pt_timer, APP_TIMER_MODE_SINGLE_SHOT, pt_timeout_handler);
+}
+
+
+uint32_t app_pt_start(app_pt_t * p_pt, app_pt_thread_t thread)
+{
+    if (p_pt->thread != NULL)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    p_pt->thread    = thread;
+    p_pt->lc        = 0;
+    p_pt->events    = 0;
+    p_pt->wait_mask = 0;
+    p_pt->received  = 0;
+    p_pt->timed     = 0;
+    p_pt->ready     = 1;
+    p_pt->p_next    = m_p_head;
+    m_p_head        = p_pt;
+
+    run_request();
+
+    return NRF_SUCCESS;
+}
+
+
+void app_pt_post(app_pt_t * p_pt, uint8_t events)
+{
+    bool wake;
+
+    CRITICAL_REGION_ENTER();
+    p_pt->events |= events;
+    wake          = (p_pt->wait_mask & events) != 0;
+    CRITICAL_REGION_EXIT();
+
+    if (wake)
+    {
+        p_pt->ready = 1;
+        run_request();
+    }
+}
+
+
+bool app_pt_is_running(app_pt_t const * p_pt)
+{
+    return p_pt->thread != NULL;
+}
+
+
+void app_pt_wait_set(app_pt_t * p_pt, uint8_t mask, uint32_t ticks)
+{
+    uint32_t now;
+
+    p_pt->wait_mask = mask;
+    p_pt->received  = 0;
+    p_pt->timed     = (ticks != 0);
+    if (p_pt->timed)
+    {
+        (void)app_timer_cnt_get(&now);
+        p_pt->deadline = (now + MIN(ticks, APP_PT_TICKS_MAX)) & RTC_COUNTER_MASK;
+    }
+}
+
+
+bool app_pt_wait_is_over(app_pt_t * p_pt)
+{
+    uint8_t  received = 0;
+    uint32_t now;
+
+    if (p_pt->wait_mask != 0)
+    {
+        CRITICAL_REGION_ENTER();
+        received      = p_pt->events & p_pt->wait_mask;
+        p_pt->events &= (uint8_t)~received;
+        CRITICAL_REGION_EXIT();
+    }
+    p_pt->received = received;
+
+    if (received == 0)
+    {
+        if (!p_pt->timed)
+        {
+            return false;
+        }
+        (void)app_timer_cnt_get(&now);
+        if (deadline_ahead(p_pt->deadline, now) != 0)
+        {
+            return false;
+        }
+    }
+
+    p_pt->wait_mask = 0;
+    p_pt->timed     = 0;
+    return true;
+}
+
+/** @} */
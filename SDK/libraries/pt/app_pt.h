@@ -0,0 +1,179 @@
+/** @file
+ *
+ * @defgroup app_pt Protothreads
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Stackless cooperative tasks run from the main loop.
+ *
+ * @details A protothread is a function which can wait for events, sleep and yield in the
+ *          middle of its body without a stack of its own. Where it stopped is kept as a line
+ *          number in the task, and the function resumes there on its next call by means of a
+ *          switch statement (the local continuation). All tasks share the main stack, so a
+ *          task costs sizeof(app_pt_t) bytes of RAM.
+ *
+ *          Because the function returns while it waits, its local variables do not survive a
+ *          wait; keep state in static variables or in a structure that embeds the app_pt_t.
+ *          A switch statement must not span a wait in the task body.
+ *
+ *          The tasks are run from a scheduler event in thread mode (see @ref app_scheduler).
+ *          Timeouts share one application timer; they are limited to @ref APP_PT_TICKS_MAX.
+ *          When all tasks wait for events without a timeout, no timer runs.
+ *
+ * @code
+ * static char blink_thread(app_pt_t * p_pt)
+ * {
+ *     APP_PT_BEGIN(p_pt);
+ *     for (;;)
+ *     {
+ *         APP_PT_WAIT_EVENT(p_pt, BLINK_EVT_START);
+ *         LEDS_ON(BSP_LED_0_MASK);
+ *         APP_PT_SLEEP(p_pt, APP_TIMER_TICKS(100));
+ *         LEDS_OFF(BSP_LED_0_MASK);
+ *     }
+ *     APP_PT_END(p_pt);
+ * }
+ * @endcode
+ */
+
+#ifndef APP_PT_H__
+#define APP_PT_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define APP_PT_WAITING  0           /**< The task waits for an event or a timeout. */
+#define APP_PT_YIELDED  1           /**< The task gave way and is run again on the next pass. */
+#define APP_PT_EXITED   2           /**< The task ended. */
+
+#define APP_PT_TICKS_MAX    0x007FFFFF  /**< Longest timeout in timer ticks (about 256 s). */
+
+typedef struct app_pt_s app_pt_t;
+
+/**@brief Task function type.
+ *
+ * @return APP_PT_WAITING, APP_PT_YIELDED or APP_PT_EXITED, as returned by the APP_PT_* macros.
+ */
+typedef char (*app_pt_thread_t)(app_pt_t * p_pt);
+
+/**@brief Task. The fields are internal to the module. */
+struct app_pt_s
+{
+    app_pt_t *        p_next;       /**< Next task in the list. */
+    app_pt_thread_t   thread;       /**< Task function. */
+    uint32_t          deadline;     /**< RTC1 counter at which a timed wait ends. */
+    uint16_t          lc;           /**< Local continuation: line at which the task resumes. */
+    volatile uint8_t  events;       /**< Events posted and not consumed yet. */
+    uint8_t           wait_mask;    /**< Events the task waits for. */
+    uint8_t           received;     /**< Events which ended the last wait, 0 after a timeout. */
+    uint8_t           timed;        /**< The current wait has a timeout. */
+    volatile uint8_t  ready;        /**< The task is to be run on the next pass. */
+};
+
+/**@brief Macro for starting the body of a task. */
+#define APP_PT_BEGIN(p_pt)                                                                  \
+    {                                                                                       \
+        char PT_YIELD_FLAG = 1;                                                             \
+        (void)PT_YIELD_FLAG;                                                                \
+        switch ((p_pt)->lc)                                                                 \
+        {                                                                                   \
+            case 0:
+
+/**@brief Macro for ending the body of a task. The task exits when it gets here. */
+#define APP_PT_END(p_pt)                                                                    \
+        }                                                                                   \
+        (p_pt)->lc = 0;                                                                     \
+        return APP_PT_EXITED;                                                               \
+    }
+
+/**@brief Macro for waiting until a condition is true. The condition is checked each time the
+ *        task is run; use it with events or timeouts which make the task run. */
+#define APP_PT_WAIT_UNTIL(p_pt, condition)                                                  \
+    do                                                                                      \
+    {                                                                                       \
+        (p_pt)->lc = __LINE__;                                                              \
+        case __LINE__:                                                                      \
+        if (!(condition))                                                                   \
+        {                                                                                   \
+            return APP_PT_WAITING;                                                          \
+        }                                                                                   \
+    } while (0)
+
+/**@brief Macro for giving way to other tasks and scheduler events. */
+#define APP_PT_YIELD(p_pt)                                                                  \
+    do                                                                                      \
+    {                                                                                       \
+        PT_YIELD_FLAG = 0;                                                                  \
+        (p_pt)->lc    = __LINE__;                                                           \
+        case __LINE__:                                                                      \
+        if (PT_YIELD_FLAG == 0)                                                             \
+        {                                                                                   \
+            return APP_PT_YIELDED;                                                          \
+        }                                                                                   \
+    } while (0)
+
+/**@brief Macro for waiting for any of the given events or for a timeout.
+ *
+ * @details Events posted before the wait are not lost; they end the wait at once. Afterwards,
+ *          @ref APP_PT_RECEIVED gives the events which ended the wait, or 0 on timeout.
+ *
+ * @param[in] p_pt   Task.
+ * @param[in] mask   Events to wait for, 0 to only wait for the timeout.
+ * @param[in] ticks  Timeout in timer ticks, 0 for none.
+ */
+#define APP_PT_WAIT_EVENT_TIMEOUT(p_pt, mask, ticks)                                        \
+    do                                                                                      \
+    {                                                                                       \
+        app_pt_wait_set((p_pt), (mask), (ticks));                                           \
+        APP_PT_WAIT_UNTIL((p_pt), app_pt_wait_is_over(p_pt));                               \
+    } while (0)
+
+/**@brief Macro for waiting for any of the given events. */
+#define APP_PT_WAIT_EVENT(p_pt, mask)   APP_PT_WAIT_EVENT_TIMEOUT((p_pt), (mask), 0)
+
+/**@brief Macro for sleeping for a number of timer ticks, see APP_TIMER_TICKS(). */
+#define APP_PT_SLEEP(p_pt, ticks)       APP_PT_WAIT_EVENT_TIMEOUT((p_pt), 0, (ticks))
+
+/**@brief Events which ended the last wait, 0 after a timeout. */
+#define APP_PT_RECEIVED(p_pt)           ((p_pt)->received)
+
+/**@brief Function for initializing the task runtime.
+ *
+ * @retval NRF_SUCCESS  If the runtime was initialized.
+ * @return Otherwise, the error returned by app_timer_create().
+ */
+uint32_t app_pt_init(void);
+
+/**@brief Function for starting a task. It runs for the first time on the next pass.
+ *
+ * @param[in] p_pt    Task, which must stay valid until the task has exited.
+ * @param[in] thread  Task function.
+ *
+ * @retval NRF_SUCCESS              If the task was started.
+ * @retval NRF_ERROR_INVALID_STATE  If the task is running already.
+ */
+uint32_t app_pt_start(app_pt_t * p_pt, app_pt_thread_t thread);
+
+/**@brief Function for posting events to a task.
+ *
+ * @details Can be called from any interrupt priority up to APP_IRQ_PRIORITY_LOW and from thread
+ *          mode. The events are kept until the task waits for them.
+ *
+ * @param[in] p_pt    Task.
+ * @param[in] events  Events to post, a bit mask.
+ */
+void app_pt_post(app_pt_t * p_pt, uint8_t events);
+
+/**@brief Function for checking whether a task is running, i.e. has been started and not exited.
+ */
+bool app_pt_is_running(app_pt_t const * p_pt);
+
+/**@brief Function for preparing a wait. Used by @ref APP_PT_WAIT_EVENT_TIMEOUT. */
+void app_pt_wait_set(app_pt_t * p_pt, uint8_t mask, uint32_t ticks);
+
+/**@brief Function for checking whether a wait is over. Used by @ref APP_PT_WAIT_EVENT_TIMEOUT. */
+bool app_pt_wait_is_over(app_pt_t * p_pt);
+
+#endif // APP_PT_H__
+
+/** @} */
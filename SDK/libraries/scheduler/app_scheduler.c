@@ -0,0 +1,320 @@
+/** @file
+ *
+ * @defgroup app_scheduler Scheduler
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Deferred execution of interrupt work in thread mode.
+ */
+
+#include "app_scheduler.h"
+#include <stddef.h>
+#include <string.h>
+#include "nrf_error.h"
+#include "app_util_platform.h"
+#ifdef APP_SCHED_PROFILE
+#include "app_timer.h"
+#endif
+
+#define QUEUE_SIZE_MAX  254             /**< Slot indexes are uint8_t and 0xFF marks the end of a list. */
+#define INDEX_NONE      0xFF            /**< End of a slot list. */
+
+STATIC_ASSERT(APP_SCHED_PRIO_COUNT <= 4);
+
+/**@brief Header stored for each event. */
+typedef struct
+{
+    app_sched_event_handler_t handler;
+    uint16_t                  event_data_size;
+    uint16_t                  put_time;             /**< Low 16 bits of the RTC1 counter when the event was put. */
+} event_header_t;
+
+STATIC_ASSERT(sizeof(event_header_t) <= APP_SCHED_EVENT_HEADER_SIZE);
+
+/**@brief Highest priority holding events, indexed by m_ready_map. */
+static const uint8_t m_first_prio[16] =
+{
+    INDEX_NONE, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0
+};
+
+static event_header_t *   m_queue_event_headers;    /**< Header slots, queue_size of them. */
+static uint8_t *          m_queue_event_data;       /**< Data slots of m_queue_event_size bytes each. */
+static uint8_t *          m_queue_next;             /**< Next slot in the same list, per slot. */
+static uint16_t           m_queue_event_size;       /**< Maximum size of the data of an event. */
+static uint8_t            m_free_head;              /**< First free slot. */
+static uint8_t            m_free_count;             /**< Number of free slots. */
+static uint8_t            m_head[APP_SCHED_PRIO_COUNT];     /**< First queued slot, per priority. */
+static uint8_t            m_tail[APP_SCHED_PRIO_COUNT];     /**< Last queued slot, per priority. */
+static uint8_t            m_skipped[APP_SCHED_PRIO_COUNT];  /**< Events of higher priority run while this priority waited. */
+static volatile uint8_t   m_ready_map;              /**< Bit n set if priority n holds events. */
+static app_sched_stats_t  m_stats;                  /**< Statistics since the last reset. */
+
+
+#ifdef APP_SCHED_PROFILE
+static uint16_t time_now(void)
+{
+    uint32_t ticks;
+
+    (void)app_timer_cnt_get(&ticks);
+    return (uint16_t)ticks;
+}
+
+
+/**@brief Function for counting the time an event waited in the queue.
+ *
+ * @details Bucket 0 counts 0 ticks and bucket n counts 2^(n-1) to 2^n - 1 ticks; the last
+ *          bucket counts everything longer. Waits longer than 2^16 ticks (2 s) wrap.
+ */
+static void latency_count(app_sched_prio_t prio, uint16_t put_time)
+{
+    uint16_t ticks  = (uint16_t)(time_now() - put_time);
+    uint8_t  bucket = 0;
+
+    while ((ticks != 0) && (bucket < APP_SCHED_LATENCY_BUCKETS - 1))
+    {
+        ticks >>= 1;
+        bucket++;
+    }
+    if (m_stats.latency[prio][bucket] != UINT16_MAX)
+    {
+        m_stats.latency[prio][bucket]++;
+    }
+}
+#endif
+
+
+/**@brief Function for taking the next event off the queue, in a critical region.
+ *
+ * @details The highest priority holding events is looked up from the bitmap, unless a lower
+ *          priority has aged past APP_SCHED_AGING_LIMIT; then the highest such priority goes.
+ *
+ * @param[out] p_prio  Priority of the event.
+ *
+ * @return Slot of the event, or INDEX_NONE if the queue is empty.
+ */
+static uint8_t queue_pop(app_sched_prio_t * p_prio)
+{
+    uint8_t map = m_ready_map;
+    uint8_t prio;
+    uint8_t lower;
+    uint8_t index;
+
+    prio = m_first_prio[map];
+    if (prio == INDEX_NONE)
+    {
+        return INDEX_NONE;
+    }
+
+    for (lower = prio + 1; lower < APP_SCHED_PRIO_COUNT; lower++)
+    {
+        if (((map & (1 << lower)) != 0) && (m_skipped[lower] >= APP_SCHED_AGING_LIMIT))
+        {
+            prio = lower;
+            m_stats.aged++;
+            break;
+        }
+    }
+
+    for (lower = prio + 1; lower < APP_SCHED_PRIO_COUNT; lower++)
+    {
+        if (((map & (1 << lower)) != 0) && (m_skipped[lower] < UINT8_MAX))
+        {
+            m_skipped[lower]++;
+        }
+    }
+    m_skipped[prio] = 0;
+
+    index        = m_head[prio];
+    m_head[prio] = m_queue_next[index];
+    if (m_head[prio] == INDEX_NONE)
+    {
+        m_ready_map &= (uint8_t)~(1 << prio);
+    }
+
+    *p_prio = (app_sched_prio_t)prio;
+    return index;
+}
+
+
+static void slot_free(uint8_t index)
+{
+    m_queue_next[index] = m_free_head;
+    m_free_head         = index;
+    m_free_count++;
+}
+
+
+uint32_t app_sched_init(uint16_t max_event_size, uint16_t queue_size, void * p_evt_buffer)
+{
+    uint8_t index;
+    uint8_t prio;
+
+    if ((queue_size == 0) || (queue_size > QUEUE_SIZE_MAX) ||
+        (p_evt_buffer == NULL) || (((uint32_t)p_evt_buffer & 0x03) != 0))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    // Headers first, followed by the data slots and the list links.
+    m_queue_event_headers = p_evt_buffer;
+    m_queue_event_data    = (uint8_t *)&m_queue_event_headers[queue_size];
+    m_queue_next          = &m_queue_event_data[queue_size * max_event_size];
+    m_queue_event_size    = max_event_size;
+
+    m_free_head  = INDEX_NONE;
+    m_free_count = 0;
+    for (index = (uint8_t)queue_size; index > 0; index--)
+    {
+        slot_free(index - 1);
+    }
+    for (prio = 0; prio < APP_SCHED_PRIO_COUNT; prio++)
+    {
+        m_head[prio]    = INDEX_NONE;
+        m_tail[prio]    = INDEX_NONE;
+        m_skipped[prio] = 0;
+    }
+    m_ready_map = 0;
+
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_stats.queue_size = (uint8_t)queue_size;
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_sched_event_put_prio(void const *              p_event_data,
+                                  uint16_t                  event_size,
+                                  app_sched_event_handler_t handler,
+                                  app_sched_prio_t          prio)
+{
+    uint32_t err_code = NRF_SUCCESS;
+    uint8_t  index;
+    uint8_t  depth;
+
+    if (prio >= APP_SCHED_PRIO_COUNT)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (event_size > m_queue_event_size)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    // The copy is done inside the critical region so that a slot never becomes visible to
+    // app_sched_execute() before its data is in place.
+    CRITICAL_REGION_ENTER();
+    if (m_free_count > prio * APP_SCHED_LEVEL_RESERVE)
+    {
+        index        = m_free_head;
+        m_free_head  = m_queue_next[index];
+        m_free_count--;
+
+        m_queue_event_headers[index].handler         = handler;
+        m_queue_event_headers[index].event_data_size = event_size;
+#ifdef APP_SCHED_PROFILE
+        m_queue_event_headers[index].put_time        = time_now();
+#endif
+        if (event_size != 0)
+        {
+            memcpy(&m_queue_event_data[index * m_queue_event_size], p_event_data, event_size);
+        }
+
+        m_queue_next[index] = INDEX_NONE;
+        if (m_head[prio] == INDEX_NONE)
+        {
+            m_head[prio] = index;
+        }
+        else
+        {
+            m_queue_next[m_tail[prio]] = index;
+        }
+        m_tail[prio]  = index;
+        m_ready_map  |= (uint8_t)(1 << prio);
+
+        depth = m_stats.queue_size - m_free_count;
+        if (depth > m_stats.depth_max)
+        {
+            m_stats.depth_max = depth;
+        }
+    }
+    else
+    {
+        m_stats.dropped[prio]++;
+        err_code = NRF_ERROR_NO_MEM;
+    }
+    CRITICAL_REGION_EXIT();
+
+    return err_code;
+}
+
+
+uint32_t app_sched_event_put(void const *              p_event_data,
+                             uint16_t                  event_size,
+                             app_sched_event_handler_t handler)
+{
+    return app_sched_event_put_prio(p_event_data, event_size, handler, APP_SCHED_PRIO_NORMAL);
+}
+
+
+void app_sched_execute(void)
+{
+    event_header_t * p_header;
+    app_sched_prio_t prio;
+    uint8_t          index = INDEX_NONE;
+
+    // A slot is off every list while its handler runs, so it can be read without locking. It is
+    // freed in the same critical region that takes the next event.
+    for (;;)
+    {
+        CRITICAL_REGION_ENTER();
+        if (index != INDEX_NONE)
+        {
+            slot_free(index);
+        }
+        index = queue_pop(&prio);
+        CRITICAL_REGION_EXIT();
+
+        if (index == INDEX_NONE)
+        {
+            break;
+        }
+
+        p_header = &m_queue_event_headers[index];
+#ifdef APP_SCHED_PROFILE
+        latency_count(prio, p_header->put_time);
+#endif
+        p_header->handler((p_header->event_data_size != 0) ?
+                              &m_queue_event_data[index * m_queue_event_size] : NULL,
+                          p_header->event_data_size);
+        m_stats.executed[prio]++;
+    }
+}
+
+
+bool app_sched_queue_is_empty(void)
+{
+    return m_ready_map == 0;
+}
+
+
+void app_sched_stats_get(app_sched_stats_t * p_stats)
+{
+    CRITICAL_REGION_ENTER();
+    *p_stats = m_stats;
+    CRITICAL_REGION_EXIT();
+}
+
+
+void app_sched_stats_reset(void)
+{
+    uint8_t queue_size;
+
+    CRITICAL_REGION_ENTER();
+    queue_size = m_stats.queue_size;
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_stats.queue_size = queue_size;
+    m_stats.depth_max  = queue_size - m_free_count;
+    CRITICAL_REGION_EXIT();
+}
+
+/** @} */
@@ -0,0 +1,174 @@
+/** @file
+ *
+ * @defgroup app_scheduler Scheduler
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Deferred execution of interrupt work in thread mode.
+ *
+ * @details Interrupt handlers put an event (a copy of up to max_event_size bytes of data and a
+ *          handler) into the queue with @ref app_sched_event_put or @ref app_sched_event_put_prio
+ *          and return. The main loop calls @ref app_sched_execute, which calls the handlers in
+ *          thread mode. Long handlers therefore no longer delay other interrupts.
+ *
+ *          Events have one of @ref APP_SCHED_PRIO_COUNT priorities. Each priority is a FIFO of
+ *          slots, and a bitmap tells which FIFOs hold events; the highest priority is found
+ *          with a lookup table, as Cortex-M0 has no CLZ instruction. So that a flood at one
+ *          priority does not starve the others:
+ *          - A FIFO which has waited while @ref APP_SCHED_AGING_LIMIT events of higher priority
+ *            ran gets its next event run first.
+ *          - Each priority leaves @ref APP_SCHED_LEVEL_RESERVE free slots per priority above it,
+ *            so that low priority events cannot fill the queue.
+ *
+ *          The slots are a buffer of fixed-size headers and data, shared by all priorities;
+ *          nothing is allocated at runtime. Use @ref APP_SCHED_INIT to reserve it.
+ *
+ *          The scheduler keeps statistics per priority, see @ref app_sched_stats_get. With
+ *          APP_SCHED_PROFILE defined they include a histogram of the time events wait in the
+ *          queue, measured with the RTC1 counter of @ref app_timer.
+ */
+
+#ifndef APP_SCHEDULER_H__
+#define APP_SCHEDULER_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "app_error.h"
+#include "app_util.h"
+
+#define APP_SCHED_EVENT_HEADER_SIZE 8       /**< Size of the header stored for each event. */
+#define APP_SCHED_LATENCY_BUCKETS   8       /**< Latency histogram buckets: 0, 1, 2-3, 4-7, ..., 64 and more ticks. */
+
+#ifndef APP_SCHED_AGING_LIMIT
+#define APP_SCHED_AGING_LIMIT       8       /**< Events of higher priority run while a priority waits, after which its next event runs first. */
+#endif
+
+#ifndef APP_SCHED_LEVEL_RESERVE
+#define APP_SCHED_LEVEL_RESERVE     2       /**< Free slots a priority leaves for each priority above it. */
+#endif
+
+/**@brief Event priorities, highest first. */
+typedef enum
+{
+    APP_SCHED_PRIO_HIGH,            /**< Errors and user input. */
+    APP_SCHED_PRIO_NORMAL,          /**< Default, used by @ref app_sched_event_put. */
+    APP_SCHED_PRIO_LOW,             /**< Completion of background transfers. */
+    APP_SCHED_PRIO_BACKGROUND,      /**< Bulk work such as sensor samples and log flushing. */
+    APP_SCHED_PRIO_COUNT
+} app_sched_prio_t;
+
+/**@brief Computes the size of the buffer needed by the scheduler.
+ *
+ * @param[in] EVENT_SIZE  Maximum size of the data of an event.
+ * @param[in] QUEUE_SIZE  Number of events that can be queued.
+ */
+#define APP_SCHED_BUF_SIZE(EVENT_SIZE, QUEUE_SIZE) \
+    (((EVENT_SIZE) + APP_SCHED_EVENT_HEADER_SIZE + 1) * (QUEUE_SIZE))
+
+/**@brief Scheduler event handler type.
+ *
+ * @param[in] p_event_data  Copy of the data given to @ref app_sched_event_put, or NULL.
+ * @param[in] event_size    Size of the data.
+ */
+typedef void (*app_sched_event_handler_t)(void * p_event_data, uint16_t event_size);
+
+/**@brief Scheduler statistics. */
+typedef struct
+{
+    uint32_t executed[APP_SCHED_PRIO_COUNT];    /**< Number of events executed, per priority. */
+    uint32_t dropped[APP_SCHED_PRIO_COUNT];     /**< Number of events dropped because the queue was full, per priority. */
+    uint32_t aged;                              /**< Number of events run ahead of higher priorities through aging. */
+    uint8_t  depth_max;                         /**< Highest number of events waiting in the queue. */
+    uint8_t  queue_size;                        /**< Number of events the queue can hold. */
+#ifdef APP_SCHED_PROFILE
+    uint16_t latency[APP_SCHED_PRIO_COUNT][APP_SCHED_LATENCY_BUCKETS]; /**< Events per RTC1 ticks waited, saturating. */
+#endif
+} app_sched_stats_t;
+
+/**@brief Macro for initializing the scheduler with a statically allocated, word-aligned buffer.
+ *
+ * @param[in] EVENT_SIZE  Maximum size of the data of an event.
+ * @param[in] QUEUE_SIZE  Number of events that can be queued, at most 254.
+ */
+#define APP_SCHED_INIT(EVENT_SIZE, QUEUE_SIZE)                                                  \
+    do                                                                                          \
+    {                                                                                           \
+        static uint32_t APP_SCHED_BUF[CEIL_DIV(APP_SCHED_BUF_SIZE((EVENT_SIZE), (QUEUE_SIZE)),  \
+                                               sizeof(uint32_t))];                              \
+        uint32_t ERR_CODE = app_sched_init((EVENT_SIZE), (QUEUE_SIZE), APP_SCHED_BUF);          \
+        APP_ERROR_CHECK(ERR_CODE);                                                              \
+    } while (0)
+
+/**@brief Function for initializing the scheduler.
+ *
+ * @details Use @ref APP_SCHED_INIT rather than calling this function directly.
+ *
+ * @param[in] max_event_size  Maximum size of the data of an event.
+ * @param[in] queue_size      Number of events that can be queued, at most 254.
+ * @param[in] p_evt_buffer    Word-aligned buffer of APP_SCHED_BUF_SIZE(max_event_size, queue_size)
+ *                            bytes.
+ *
+ * @retval NRF_SUCCESS              If the scheduler was initialized.
+ * @retval NRF_ERROR_INVALID_PARAM  If queue_size is out of range or the buffer is not
+ *                                  word-aligned.
+ */
+uint32_t app_sched_init(uint16_t max_event_size, uint16_t queue_size, void * p_evt_buffer);
+
+/**@brief Function for putting an event into the queue with a priority.
+ *
+ * @details Can be called from any interrupt priority and from thread mode. The data is copied,
+ *          so it may live on the stack of the caller.
+ *
+ * @param[in] p_event_data  Data to copy into the queue, NULL if event_size is 0.
+ * @param[in] event_size    Size of the data.
+ * @param[in] handler       Handler to call from @ref app_sched_execute.
+ * @param[in] prio          Priority of the event.
+ *
+ * @retval NRF_SUCCESS              If the event was queued.
+ * @retval NRF_ERROR_INVALID_PARAM  If prio is out of range.
+ * @retval NRF_ERROR_INVALID_LENGTH If event_size exceeds the maximum event size.
+ * @retval NRF_ERROR_NO_MEM         If no slot was free for this priority; the event is counted
+ *                                  as dropped.
+ *
+ * @note Called from the UART interrupt path in RAM, hence __LONG_CALL.
+ */
+__LONG_CALL uint32_t app_sched_event_put_prio(void const *              p_event_data,
+                                              uint16_t                  event_size,
+                                              app_sched_event_handler_t handler,
+                                              app_sched_prio_t          prio);
+
+/**@brief Function for putting an event into the queue with APP_SCHED_PRIO_NORMAL.
+ *
+ * @details See @ref app_sched_event_put_prio.
+ */
+uint32_t app_sched_event_put(void const *              p_event_data,
+                             uint16_t                  event_size,
+                             app_sched_event_handler_t handler);
+
+/**@brief Function for executing all queued events, including events put while executing.
+ *
+ * @details Events run highest priority first, and in the order they were put within a
+ *          priority, except when aging lets a waiting priority go first. Must be called from
+ *          thread mode only, typically from the main loop.
+ */
+void app_sched_execute(void);
+
+/**@brief Function for checking whether events are waiting in the queue.
+ *
+ * @retval true   If the queue is empty.
+ * @retval false  If events are waiting.
+ */
+bool app_sched_queue_is_empty(void);
+
+/**@brief Function for getting the scheduler statistics gathered since the last reset.
+ *
+ * @param[out] p_stats  Statistics.
+ */
+void app_sched_stats_get(app_sched_stats_t * p_stats);
+
+/**@brief Function for resetting the scheduler statistics. */
+void app_sched_stats_reset(void);
+
+#endif // APP_SCHEDULER_H__
+
+/** @} */
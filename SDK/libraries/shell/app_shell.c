@@ -0,0 +1,381 @@
+/** @file
+ *
+ * @defgroup app_shell Command shell on RTT
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Non-blocking command line shell on RTT down-buffer 0.
+ */
+
+#include "app_shell.h"
+#include <string.h>
+#include "nrf_error.h"
+#include "nordic_common.h"
+#include "SEGGER_RTT.h"
+
+#define KEY_CTRL_C      0x03
+#define KEY_BACKSPACE   0x08
+#define KEY_TAB         0x09
+#define KEY_LF          0x0A
+#define KEY_CR          0x0D
+#define KEY_CTRL_U      0x15
+#define KEY_DELETE      0x7F
+
+#define HELP_NAME_WIDTH 11      /**< Column at which help text starts. */
+#define READ_CHUNK_SIZE 16      /**< Characters fetched from RTT at a time. */
+
+static void help_cmd(uint32_t argc, char ** argv);
+
+static const app_shell_cmd_t m_builtin_cmds[] =
+{
+    {"help", "list commands", help_cmd},
+};
+
+static app_shell_cmd_set_t m_builtin_set =
+{
+    m_builtin_cmds, sizeof(m_builtin_cmds) / sizeof(m_builtin_cmds[0]), NULL
+};
+
+static app_shell_cmd_set_t * mp_sets = &m_builtin_set;  /**< Registered command sets. */
+static char const *          mp_prompt;                 /**< Prompt printed before each line. */
+static char                  m_line[APP_SHELL_LINE_SIZE];
+static uint32_t              m_line_len;
+static char                  m_last_key;                /**< To treat CR LF as a single line end. */
+static const char            m_padding[HELP_NAME_WIDTH] = "           ";
+
+
+static void shell_write(char const * p_str, uint32_t length)
+{
+    SEGGER_RTT_Write(0, p_str, length);
+}
+
+
+static void shell_puts(char const * p_str)
+{
+    SEGGER_RTT_WriteString(0, p_str);
+}
+
+
+static void prompt_print(void)
+{
+    shell_puts("\r\n");
+    if (mp_prompt != NULL)
+    {
+        shell_puts(mp_prompt);
+    }
+}
+
+
+static void help_cmd(uint32_t argc, char ** argv)
+{
+    app_shell_cmd_set_t const * p_set;
+    uint32_t                    i;
+
+    UNUSED_PARAMETER(argc);
+    UNUSED_PARAMETER(argv);
+
+    for (p_set = mp_sets; p_set != NULL; p_set = p_set->p_next)
+    {
+        for (i = 0; i < p_set->count; i++)
+        {
+            uint32_t len = strlen(p_set->p_cmds[i].p_name);
+
+            // SEGGER_RTT_printf ignores the field width of %s, so pad by hand.
+            SEGGER_RTT_printf(0, "\r\n  %s", p_set->p_cmds[i].p_name);
+            shell_write(m_padding, (len < HELP_NAME_WIDTH) ? (HELP_NAME_WIDTH - len) : 1);
+            shell_puts(p_set->p_cmds[i].p_help);
+        }
+    }
+}
+
+
+/**@brief Function for splitting the line into arguments, in place.
+ *
+ * @return Number of arguments found.
+ */
+static uint32_t line_split(char * p_line, char ** argv)
+{
+    uint32_t argc = 0;
+
+    while (argc < APP_SHELL_MAX_ARGS)
+    {
+        while (*p_line == ' ')
+        {
+            p_line++;
+        }
+        if (*p_line == '\0')
+        {
+            break;
+        }
+
+        if (*p_line == '"')
+        {
+            argv[argc++] = ++p_line;
+            while ((*p_line != '"') && (*p_line != '\0'))
+            {
+                p_line++;
+            }
+        }
+        else
+        {
+            argv[argc++] = p_line;
+            while ((*p_line != ' ') && (*p_line != '\0'))
+            {
+                p_line++;
+            }
+        }
+
+        if (*p_line == '\0')
+        {
+            break;
+        }
+        *p_line++ = '\0';
+    }
+    return argc;
+}
+
+
+static app_shell_cmd_t const * cmd_find(char const * p_name)
+{
+    app_shell_cmd_set_t const * p_set;
+    uint32_t                    i;
+
+    for (p_set = mp_sets; p_set != NULL; p_set = p_set->p_next)
+    {
+        for (i = 0; i < p_set->count; i++)
+        {
+            if (strcmp(p_set->p_cmds[i].p_name, p_name) == 0)
+            {
+                return &p_set->p_cmds[i];
+            }
+        }
+    }
+    return NULL;
+}
+
+
+static void line_execute(void)
+{
+    char *                  argv[APP_SHELL_MAX_ARGS];
+    uint32_t                argc;
+    app_shell_cmd_t const * p_cmd;
+
+    m_line[m_line_len] = '\0';
+    m_line_len         = 0;
+
+    argc = line_split(m_line, argv);
+    if (argc == 0)
+    {
+        return;
+    }
+
+    p_cmd = cmd_find(argv[0]);
+    if (p_cmd == NULL)
+    {
+        SEGGER_RTT_printf(0, "\r\n%s: command not found", argv[0]);
+        return;
+    }
+    p_cmd->handler(argc, argv);
+}
+
+
+/**@brief Function for completing the command name at the start of the line.
+ *
+ * @details A unique match is completed including the trailing space. With several matches,
+ *          the line is extended to their common prefix and the candidates are listed.
+ */
+static void line_complete(void)
+{
+    app_shell_cmd_set_t const * p_set;
+    char const *                p_match = NULL;
+    uint32_t                    match_len = 0;
+    uint32_t                    matches = 0;
+    uint32_t                    i;
+
+    // Only the command name is completed.
+    if (memchr(m_line, ' ', m_line_len) != NULL)
+    {
+        return;
+    }
+
+    for (p_set = mp_sets; p_set != NULL; p_set = p_set->p_next)
+    {
+        for (i = 0; i < p_set->count; i++)
+        {
+            char const * p_name = p_set->p_cmds[i].p_name;
+
+            if (strncmp(p_name, m_line, m_line_len) != 0)
+            {
+                continue;
+            }
+            if (matches++ == 0)
+            {
+                p_match   = p_name;
+                match_len = strlen(p_name);
+            }
+            else
+            {
+                uint32_t common = m_line_len;
+
+                while ((common < match_len) && (p_name[common] == p_match[common]))
+                {
+                    common++;
+                }
+                match_len = common;
+            }
+        }
+    }
+
+    if (matches == 0)
+    {
+        return;
+    }
+
+    if (matches > 1)
+    {
+        for (p_set = mp_sets; p_set != NULL; p_set = p_set->p_next)
+        {
+            for (i = 0; i < p_set->count; i++)
+            {
+                if (strncmp(p_set->p_cmds[i].p_name, m_line, m_line_len) == 0)
+                {
+                    SEGGER_RTT_printf(0, "\r\n  %s", p_set->p_cmds[i].p_name);
+                }
+            }
+        }
+        prompt_print();
+        shell_write(m_line, m_line_len);
+    }
+
+    if (match_len >= APP_SHELL_LINE_SIZE - 1)
+    {
+        return;
+    }
+    shell_write(&p_match[m_line_len], match_len - m_line_len);
+    memcpy(&m_line[m_line_len], &p_match[m_line_len], match_len - m_line_len);
+    m_line_len = match_len;
+
+    if ((matches == 1) && (m_line_len < APP_SHELL_LINE_SIZE - 1))
+    {
+        m_line[m_line_len++] = ' ';
+        shell_write(" ", 1);
+    }
+}
+
+
+static void key_handle(char key)
+{
+    switch (key)
+    {
+        case KEY_LF:
+            if (m_last_key == KEY_CR)
+            {
+                break;
+            }
+            // Fall through.
+        case KEY_CR:
+            line_execute();
+            prompt_print();
+            break;
+
+        case KEY_BACKSPACE:
+        case KEY_DELETE:
+            if (m_line_len > 0)
+            {
+                m_line_len--;
+                shell_puts("\b \b");
+            }
+            break;
+
+        case KEY_CTRL_U:
+            while (m_line_len > 0)
+            {
+                m_line_len--;
+                shell_puts("\b \b");
+            }
+            break;
+
+        case KEY_CTRL_C:
+            m_line_len = 0;
+            shell_puts("^C");
+            prompt_print();
+            break;
+
+        case KEY_TAB:
+            line_complete();
+            break;
+
+        default:
+            if ((key < ' ') || (m_line_len >= APP_SHELL_LINE_SIZE - 1))
+            {
+                break;
+            }
+            m_line[m_line_len++] = key;
+#if APP_SHELL_ECHO
+            shell_write(&key, 1);
+#endif
+            break;
+    }
+    m_last_key = key;
+}
+
+
+uint32_t app_shell_init(char const * p_prompt)
+{
+    mp_prompt  = p_prompt;
+    m_line_len = 0;
+    m_last_key = 0;
+    prompt_print();
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_shell_register(app_shell_cmd_set_t * p_set)
+{
+    app_shell_cmd_set_t * p_last;
+
+    if ((p_set == NULL) || (p_set->p_cmds == NULL))
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    for (p_last = mp_sets; ; p_last = p_last->p_next)
+    {
+        if (p_last == p_set)
+        {
+            return NRF_ERROR_INVALID_STATE;
+        }
+        if (p_last->p_next == NULL)
+        {
+            break;
+        }
+    }
+
+    // Appended, so that help lists the commands in registration order.
+    p_set->p_next  = NULL;
+    p_last->p_next = p_set;
+
+    return NRF_SUCCESS;
+}
+
+
+bool app_shell_process(void)
+{
+    char     buf[READ_CHUNK_SIZE];
+    int      count;
+    int      i;
+    bool     received = false;
+
+    while ((count = SEGGER_RTT_Read(0, buf, sizeof(buf))) > 0)
+    {
+        received = true;
+        for (i = 0; i < count; i++)
+        {
+            key_handle(buf[i]);
+        }
+    }
+    return received;
+}
+
+/** @} */
@@ -0,0 +1,96 @@
+/** @file
+ *
+ * @defgroup app_shell Command shell on RTT
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Non-blocking command line shell on RTT down-buffer 0.
+ *
+ * @details @ref app_shell_process drains whatever the host has written to RTT down-buffer 0
+ *          and returns immediately; it never waits for input. Call it from the main loop on
+ *          every tick or wakeup. Complete lines are split into arguments and dispatched to
+ *          the matching command of the registered command sets.
+ *
+ *          Supported editing keys: Backspace/Delete (erase character), Ctrl-U (erase line),
+ *          Ctrl-C (discard line) and Tab (complete command name). Arguments are separated by
+ *          spaces; double quotes group an argument containing spaces.
+ */
+
+#ifndef APP_SHELL_H__
+#define APP_SHELL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef APP_SHELL_LINE_SIZE
+#define APP_SHELL_LINE_SIZE     64      /**< Maximum length of a command line, including terminator. */
+#endif
+
+#ifndef APP_SHELL_MAX_ARGS
+#define APP_SHELL_MAX_ARGS      8       /**< Maximum number of arguments, including the command name. */
+#endif
+
+#ifndef APP_SHELL_ECHO
+#define APP_SHELL_ECHO          1       /**< Echo received characters back to RTT up-buffer 0. */
+#endif
+
+/**@brief Command handler type.
+ *
+ * @param[in] argc  Number of arguments, including the command name in argv[0].
+ * @param[in] argv  Arguments. The strings are valid until the handler returns.
+ */
+typedef void (*app_shell_cmd_handler_t)(uint32_t argc, char ** argv);
+
+/**@brief Shell command. */
+typedef struct
+{
+    char const *            p_name;     /**< Command name, matched against the first argument. */
+    char const *            p_help;     /**< One-line description printed by the help command. */
+    app_shell_cmd_handler_t handler;    /**< Function called with the parsed arguments. */
+} app_shell_cmd_t;
+
+/**@brief Set of shell commands.
+ *
+ * @details Each module registers its own set. The structure is linked into a list by
+ *          @ref app_shell_register and must therefore stay in memory (static or global).
+ */
+typedef struct app_shell_cmd_set_s
+{
+    app_shell_cmd_t const *       p_cmds;   /**< Array of commands. */
+    uint8_t                       count;    /**< Number of commands in p_cmds. */
+    struct app_shell_cmd_set_s *  p_next;   /**< Used internally to chain sets. */
+} app_shell_cmd_set_t;
+
+/**@brief Function for initializing the shell.
+ *
+ * @details Discards any partial input and prints the prompt. The built-in "help" command is
+ *          always available.
+ *
+ * @param[in] p_prompt  Prompt printed before each line. Must stay valid. Can be NULL for none.
+ *
+ * @retval NRF_SUCCESS  If the shell was initialized.
+ */
+uint32_t app_shell_init(char const * p_prompt);
+
+/**@brief Function for registering a set of commands.
+ *
+ * @param[in] p_set  Command set. Must stay valid for as long as the shell is used.
+ *
+ * @retval NRF_SUCCESS              If the set was registered.
+ * @retval NRF_ERROR_NULL           If p_set or its command array is NULL.
+ * @retval NRF_ERROR_INVALID_STATE  If the set is already registered.
+ */
+uint32_t app_shell_register(app_shell_cmd_set_t * p_set);
+
+/**@brief Function for processing received input.
+ *
+ * @details Handles all characters currently available in RTT down-buffer 0 and dispatches
+ *          complete lines. Returns as soon as the buffer is empty.
+ *
+ * @return  true if any input was received, false if the buffer was empty.
+ */
+bool app_shell_process(void);
+
+#endif // APP_SHELL_H__
+
+/** @} */
@@ -0,0 +1,53 @@
+/** @file
+ *
+ * @defgroup app_stack Stack high-water mark
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Deepest stack use since reset, found from a pattern painted at startup.
+ */
+
+#include "app_stack.h"
+#include "nrf_error.h"
+
+extern uint32_t __StackLimit;                   /**< Bottom of the stack, from the startup file. */
+extern uint32_t __StackTop;                     /**< Top of the stack, from the startup file. */
+
+static uint32_t const * m_p_low = &__StackTop;  /**< Lowest word known to have been used. */
+
+
+uint32_t app_stack_init(void)
+{
+    return (__StackLimit == APP_STACK_PAINT) ? NRF_SUCCESS : NRF_ERROR_INVALID_STATE;
+}
+
+
+uint32_t app_stack_size_get(void)
+{
+    return (uint32_t)&__StackTop - (uint32_t)&__StackLimit;
+}
+
+
+uint32_t app_stack_used_max_get(void)
+{
+    uint32_t const * p_word = &__StackLimit;
+
+    // The words above m_p_low are known to be used; only the ones below can change the mark.
+    while ((p_word < m_p_low) && (*p_word == APP_STACK_PAINT))
+    {
+        p_word++;
+    }
+    m_p_low = p_word;
+
+    return (uint32_t)&__StackTop - (uint32_t)m_p_low;
+}
+
+
+uint32_t app_stack_check(uint32_t * p_used)
+{
+    *p_used = app_stack_used_max_get();
+
+    return (*p_used + APP_STACK_MARGIN > app_stack_size_get()) ? NRF_ERROR_NO_MEM : NRF_SUCCESS;
+}
+
+/** @} */
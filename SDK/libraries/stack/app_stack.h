@@ -0,0 +1,60 @@
+/** @file
+ *
+ * @defgroup app_stack Stack high-water mark
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Deepest stack use since reset, found from a pattern painted at startup.
+ *
+ * @details With __STARTUP_PAINT_STACK defined for the assembler, Reset_Handler fills the stack
+ *          from __StackLimit up to the initial stack pointer with @ref APP_STACK_PAINT before
+ *          anything else runs. Every word the code or an interrupt writes loses the pattern, so
+ *          the lowest changed word marks the deepest use. Only the words below the deepest use
+ *          found so far are read again, so a check costs roughly one load per unused word.
+ *
+ *          The mark can read a little low: a word written with the pattern value itself, or a
+ *          frame reserved but never written, is not seen. Keep a margin when sizing the stack
+ *          from it, and compare with the static worst case from host/stack_report.
+ *
+ *          The stack size is Stack_Size in gcc_startup_nrf51.s, set with __STACK_SIZE.
+ */
+
+#ifndef APP_STACK_H__
+#define APP_STACK_H__
+
+#include <stdint.h>
+
+#define APP_STACK_PAINT         0xA5A5A5A5UL    /**< Pattern written by Reset_Handler; keep the two in step. */
+
+#ifndef APP_STACK_MARGIN
+#define APP_STACK_MARGIN        256             /**< Free stack in bytes below which @ref app_stack_check warns. */
+#endif
+
+/**@brief Function for checking that the stack was painted and has not overflowed yet.
+ *
+ * @retval NRF_SUCCESS              If the bottom word still holds the pattern.
+ * @retval NRF_ERROR_INVALID_STATE  If the stack was not painted, or was used to the bottom.
+ */
+uint32_t app_stack_init(void);
+
+/**@brief Function for getting the size of the stack in bytes. */
+uint32_t app_stack_size_get(void);
+
+/**@brief Function for getting the deepest stack use since reset.
+ *
+ * @return Bytes used, from __StackTop down to the lowest word which lost the pattern.
+ */
+uint32_t app_stack_used_max_get(void);
+
+/**@brief Function for checking the free stack against @ref APP_STACK_MARGIN.
+ *
+ * @param[out] p_used  Deepest use in bytes, as from @ref app_stack_used_max_get.
+ *
+ * @retval NRF_SUCCESS        If at least APP_STACK_MARGIN bytes were never used.
+ * @retval NRF_ERROR_NO_MEM   If less was left at some point, or the stack overflowed.
+ */
+uint32_t app_stack_check(uint32_t * p_used);
+
+#endif // APP_STACK_H__
+
+/** @} */
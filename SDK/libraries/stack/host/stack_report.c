@@ -0,0 +1,476 @@
+/** @file
+ *
+ * @brief Host report of the worst-case stack depth of every call chain.
+ *
+ * @details Reads the disassembly of the application (arm-none-eabi-objdump -d) from stdin and
+ *          the .su files written by -fstack-usage, named as arguments. Each function in the
+ *          disassembly gets its frame size from the .su files, and its callees from its bl
+ *          instructions, and from b instructions to the start of another function, which are
+ *          tail calls. The depth of a function is its frame plus the deepest of its callees;
+ *          for a tail call, the frame is released first. A call through a linker veneer, such as
+ *          __app_fifo_put_veneer for a function in RAM, counts as a call to the function itself.
+ *
+ *          The functions which nothing calls are the roots: main, the interrupt handlers and
+ *          functions only reached through pointers. Each is printed with its depth and its
+ *          deepest chain, deepest first, followed by the estimate for the whole application:
+ *          main, plus the deepest handler and the 32-byte exception frame it pushes. Handlers at
+ *          different priorities can nest; add them up in that case.
+ *
+ *          Flags after a depth mark where it can be too low:
+ *          - ?  a function on the chain has no .su entry (assembly, libraries);
+ *          - +  a frame is dynamic or bounded (alloca, variable-length arrays);
+ *          - *  a function calls through a pointer, and those callees are not followed;
+ *          - R  a function is recursive; the recursion is counted once.
+ *
+ *          Static functions of the same name in different files share the largest frame.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LINE_SIZE           1024
+#define NAME_SIZE           128
+#define EXCEPTION_FRAME     32      /**< Bytes pushed by the Cortex-M0 on exception entry. */
+
+#define FLAG_NO_SU          (1 << 0)
+#define FLAG_DYNAMIC        (1 << 1)
+#define FLAG_INDIRECT       (1 << 2)
+#define FLAG_RECURSIVE      (1 << 3)
+
+/**@brief Call from one function to another. */
+typedef struct
+{
+    uint32_t callee;        /**< Index of the callee. */
+    bool     tail;          /**< Tail call: the caller's frame is released first. */
+} call_t;
+
+typedef struct
+{
+    char     name[NAME_SIZE];
+    uint32_t addr;
+    uint32_t frame;         /**< Own frame in bytes. */
+    uint32_t flags;         /**< Own FLAG_ bits. */
+    call_t * p_calls;
+    uint32_t call_count;
+    uint32_t callers;       /**< Number of functions calling this one. */
+    uint32_t depth;         /**< Worst-case depth, once visited. */
+    uint32_t chain_flags;   /**< FLAG_ bits along the deepest chain and below. */
+    int32_t  next;          /**< Next function on the deepest chain, -1 for none. */
+    uint8_t  state;         /**< 0 not visited, 1 being visited, 2 done. */
+} func_t;
+
+static func_t * m_funcs;
+static uint32_t m_func_count;
+
+
+static int func_compare(const void * p_a, const void * p_b)
+{
+    return strcmp(((func_t const *)p_a)->name, ((func_t const *)p_b)->name);
+}
+
+
+static int32_t func_find(const char * p_name)
+{
+    func_t   key;
+    func_t * p_func;
+
+    snprintf(key.name, sizeof(key.name), "%s", p_name);
+    p_func = bsearch(&key, m_funcs, m_func_count, sizeof(func_t), func_compare);
+    return (p_func == NULL) ? -1 : (int32_t)(p_func - m_funcs);
+}
+
+
+static void * checked_realloc(void * p_old, size_t size)
+{
+    void * p_new = realloc(p_old, size);
+
+    if (p_new == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(2);
+    }
+    return p_new;
+}
+
+
+/**@brief Function for reading "<addr> <name>:" function headers of the disassembly. */
+static bool header_parse(const char * p_line, uint32_t * p_addr, char * p_name)
+{
+    char         name[NAME_SIZE];
+    unsigned int addr;
+    size_t       length;
+
+    if ((sscanf(p_line, "%x <%127[^>]>:", &addr, name) != 2) ||
+        ((length = strlen(p_line)) < 3) || (strstr(p_line, ">:") == NULL))
+    {
+        return false;
+    }
+    *p_addr = addr;
+    strcpy(p_name, name);
+    return true;
+}
+
+
+/**@brief Function for splitting an instruction line into mnemonic and operands.
+ *
+ * @details Lines read "   addr:\thex \tmnemonic\toperands".
+ */
+static bool insn_parse(char * p_line, char ** pp_mnemonic, char ** pp_operands)
+{
+    char * p_field = strchr(p_line, '\t');
+
+    if ((p_field == NULL) || ((p_field = strchr(p_field + 1, '\t')) == NULL))
+    {
+        return false;
+    }
+    *pp_mnemonic = p_field + 1;
+    p_field      = strchr(*pp_mnemonic, '\t');
+    if (p_field == NULL)
+    {
+        *pp_operands = *pp_mnemonic + strlen(*pp_mnemonic);
+    }
+    else
+    {
+        *p_field     = '\0';
+        *pp_operands = p_field + 1;
+    }
+    (*pp_operands)[strcspn(*pp_operands, "\r\n")] = '\0';
+    return true;
+}
+
+
+/**@brief Function for checking whether a function is a linker veneer, "__<name>_veneer". */
+static bool is_veneer(const char * p_name)
+{
+    size_t length = strlen(p_name);
+
+    return (length > strlen("___veneer")) && (strncmp(p_name, "__", 2) == 0) &&
+           (strcmp(p_name + length - strlen("_veneer"), "_veneer") == 0);
+}
+
+
+/**@brief Function for getting the function a branch goes to the start of, or -1. */
+static int32_t branch_target(const char * p_operands)
+{
+    char         name[NAME_SIZE];
+    unsigned int addr;
+
+    // "18bf4 <app_timer_init>"; "<main+0x8>" is a branch within a function.
+    if ((sscanf(p_operands, "%x <%127[^>]>", &addr, name) != 2) || (strchr(name, '+') != NULL))
+    {
+        return -1;
+    }
+    if (is_veneer(name))
+    {
+        name[strlen(name) - strlen("_veneer")] = '\0';
+        return func_find(name + 2);
+    }
+    return func_find(name);
+}
+
+
+static void call_add(func_t * p_func, int32_t callee, bool tail)
+{
+    uint32_t i;
+
+    for (i = 0; i < p_func->call_count; i++)
+    {
+        if (p_func->p_calls[i].callee == (uint32_t)callee)
+        {
+            p_func->p_calls[i].tail &= tail;
+            return;
+        }
+    }
+    p_func->p_calls = checked_realloc(p_func->p_calls, (p_func->call_count + 1) * sizeof(call_t));
+    p_func->p_calls[p_func->call_count].callee = (uint32_t)callee;
+    p_func->p_calls[p_func->call_count].tail   = tail;
+    p_func->call_count++;
+    if (&m_funcs[callee] != p_func)
+    {
+        m_funcs[callee].callers++;
+    }
+}
+
+
+/**@brief Function for reading the disassembly: functions first, then their calls. */
+static void disassembly_read(FILE * p_in)
+{
+    char **  pp_lines   = NULL;
+    uint32_t line_count = 0;
+    char     line[LINE_SIZE];
+    char     name[NAME_SIZE];
+    char *   p_mnemonic;
+    char *   p_operands;
+    uint32_t addr;
+    uint32_t i;
+    int32_t  current = -1;
+    int32_t  target;
+
+    while (fgets(line, sizeof(line), p_in) != NULL)
+    {
+        pp_lines             = checked_realloc(pp_lines, (line_count + 1) * sizeof(char *));
+        pp_lines[line_count] = strdup(line);
+        line_count++;
+
+        if (header_parse(line, &addr, name))
+        {
+            m_funcs = checked_realloc(m_funcs, (m_func_count + 1) * sizeof(func_t));
+            memset(&m_funcs[m_func_count], 0, sizeof(func_t));
+            strcpy(m_funcs[m_func_count].name, name);
+            m_funcs[m_func_count].addr  = addr;
+            m_funcs[m_func_count].flags = FLAG_NO_SU;
+            m_funcs[m_func_count].next  = -1;
+            m_func_count++;
+        }
+    }
+    qsort(m_funcs, m_func_count, sizeof(func_t), func_compare);
+
+    for (i = 0; i < line_count; i++)
+    {
+        if (header_parse(pp_lines[i], &addr, name))
+        {
+            current = func_find(name);
+        }
+        else if ((current >= 0) && insn_parse(pp_lines[i], &p_mnemonic, &p_operands))
+        {
+            if (strcmp(p_mnemonic, "bl") == 0)
+            {
+                target = branch_target(p_operands);
+                if (target >= 0)
+                {
+                    call_add(&m_funcs[current], target, false);
+                }
+            }
+            else if ((strcmp(p_mnemonic, "b") == 0) || (strcmp(p_mnemonic, "b.n") == 0) ||
+                     (strcmp(p_mnemonic, "b.w") == 0))
+            {
+                target = branch_target(p_operands);
+                if ((target >= 0) && (target != current))
+                {
+                    call_add(&m_funcs[current], target, true);
+                }
+            }
+            else if (((strcmp(p_mnemonic, "blx") == 0) || (strcmp(p_mnemonic, "bx") == 0)) &&
+                     (strcmp(p_operands, "lr") != 0))
+            {
+                m_funcs[current].flags |= FLAG_INDIRECT;
+            }
+        }
+        free(pp_lines[i]);
+    }
+    free(pp_lines);
+}
+
+
+/**@brief Function for reading the frame sizes from a .su file.
+ *
+ * @details Lines read "file.c:line:column:name\tbytes\tstatic|dynamic|dynamic,bounded".
+ */
+static void su_read(const char * p_path)
+{
+    FILE *       p_in = fopen(p_path, "r");
+    char         line[LINE_SIZE];
+    char         qualifier[NAME_SIZE];
+    char *       p_name;
+    char *       p_tab;
+    unsigned int bytes;
+    int32_t      index;
+
+    if (p_in == NULL)
+    {
+        perror(p_path);
+        exit(2);
+    }
+    while (fgets(line, sizeof(line), p_in) != NULL)
+    {
+        p_tab = strchr(line, '\t');
+        if (p_tab == NULL)
+        {
+            continue;
+        }
+        *p_tab = '\0';
+        if (sscanf(p_tab + 1, "%u %127s", &bytes, qualifier) != 2)
+        {
+            continue;
+        }
+        p_name = strrchr(line, ':');
+        p_name = (p_name == NULL) ? line : p_name + 1;
+
+        index = func_find(p_name);
+        if (index < 0)
+        {
+            // Removed by --gc-sections, or inlined everywhere.
+            continue;
+        }
+        if (((m_funcs[index].flags & FLAG_NO_SU) != 0) || (bytes > m_funcs[index].frame))
+        {
+            m_funcs[index].frame = bytes;
+        }
+        m_funcs[index].flags &= ~FLAG_NO_SU;
+        if (strncmp(qualifier, "dynamic", strlen("dynamic")) == 0)
+        {
+            m_funcs[index].flags |= FLAG_DYNAMIC;
+        }
+    }
+    fclose(p_in);
+}
+
+
+/**@brief Function for computing the worst-case depth of a function, depth first. */
+static void depth_visit(uint32_t index)
+{
+    func_t * p_func = &m_funcs[index];
+    func_t * p_callee;
+    uint32_t depth;
+    uint32_t i;
+
+    if (p_func->state == 2)
+    {
+        return;
+    }
+    p_func->state       = 1;
+    p_func->depth       = p_func->frame;
+    p_func->chain_flags = p_func->flags;
+
+    for (i = 0; i < p_func->call_count; i++)
+    {
+        p_callee = &m_funcs[p_func->p_calls[i].callee];
+        if (p_callee->state == 1)
+        {
+            p_func->chain_flags |= FLAG_RECURSIVE;
+            p_callee->flags     |= FLAG_RECURSIVE;
+            continue;
+        }
+        depth_visit(p_func->p_calls[i].callee);
+
+        depth = p_callee->depth + (p_func->p_calls[i].tail ? 0 : p_func->frame);
+        if (depth > p_func->depth)
+        {
+            p_func->depth = depth;
+            p_func->next  = (int32_t)p_func->p_calls[i].callee;
+        }
+        // Unknowns anywhere below make the depth a lower bound, not only on the deepest chain.
+        p_func->chain_flags |= p_callee->chain_flags;
+    }
+    p_func->state = 2;
+}
+
+
+static int root_compare(const void * p_a, const void * p_b)
+{
+    func_t const * p_func_a = &m_funcs[*(uint32_t const *)p_a];
+    func_t const * p_func_b = &m_funcs[*(uint32_t const *)p_b];
+
+    if (p_func_a->depth != p_func_b->depth)
+    {
+        return (p_func_a->depth < p_func_b->depth) ? 1 : -1;
+    }
+    return strcmp(p_func_a->name, p_func_b->name);
+}
+
+
+static void flags_print(uint32_t flags)
+{
+    printf(" %c%c%c%c",
+           ((flags & FLAG_NO_SU) != 0)     ? '?' : ' ',
+           ((flags & FLAG_DYNAMIC) != 0)   ? '+' : ' ',
+           ((flags & FLAG_INDIRECT) != 0)  ? '*' : ' ',
+           ((flags & FLAG_RECURSIVE) != 0) ? 'R' : ' ');
+}
+
+
+static void root_print(uint32_t index)
+{
+    int32_t next;
+
+    printf("%6u", m_funcs[index].depth);
+    flags_print(m_funcs[index].chain_flags);
+    printf(" %s", m_funcs[index].name);
+    for (next = m_funcs[index].next; next >= 0; next = m_funcs[next].next)
+    {
+        printf(" > %s(%u)", m_funcs[next].name, m_funcs[next].frame);
+    }
+    printf("\n");
+}
+
+
+/**@brief Function for checking whether a function is an exception or interrupt handler. */
+static bool is_handler(const char * p_name)
+{
+    size_t length = strlen(p_name);
+
+    // Reset_Handler never returns to anything, it is the bottom of the main stack.
+    return (length > strlen("Handler")) &&
+           (strcmp(p_name + length - strlen("Handler"), "Handler") == 0) &&
+           (strcmp(p_name, "Reset_Handler") != 0);
+}
+
+
+int main(int argc, char ** argv)
+{
+    uint32_t * p_roots;
+    uint32_t   root_count = 0;
+    uint32_t   handler    = 0;
+    int32_t    handler_max = -1;
+    int32_t    main_index;
+    int        i;
+    uint32_t   j;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: arm-none-eabi-objdump -d app.out | %s file.su...\n", argv[0]);
+        return 2;
+    }
+
+    disassembly_read(stdin);
+    if (m_func_count == 0)
+    {
+        fprintf(stderr, "no functions in the disassembly on stdin\n");
+        return 1;
+    }
+    for (i = 1; i < argc; i++)
+    {
+        su_read(argv[i]);
+    }
+
+    p_roots = checked_realloc(NULL, m_func_count * sizeof(uint32_t));
+    for (j = 0; j < m_func_count; j++)
+    {
+        depth_visit(j);
+        if ((m_funcs[j].callers == 0) && !is_veneer(m_funcs[j].name))
+        {
+            p_roots[root_count++] = j;
+        }
+    }
+    qsort(p_roots, root_count, sizeof(uint32_t), root_compare);
+
+    printf("Worst-case stack depth in bytes of the functions nothing calls, with the deepest chain\n");
+    printf("(frame of each callee in brackets; ? no .su, + dynamic, * calls through pointers, R recursion):\n");
+    for (j = 0; j < root_count; j++)
+    {
+        root_print(p_roots[j]);
+        if (is_handler(m_funcs[p_roots[j]].name) && (handler_max < 0))
+        {
+            handler_max = (int32_t)p_roots[j];
+            handler     = m_funcs[p_roots[j]].depth;
+        }
+    }
+
+    main_index = func_find("main");
+    if (main_index >= 0)
+    {
+        printf("\nmain %u + deepest handler %u (%s) + exception frame %u = %u bytes",
+               m_funcs[main_index].depth, handler,
+               (handler_max >= 0) ? m_funcs[handler_max].name : "none", EXCEPTION_FRAME,
+               m_funcs[main_index].depth + handler + EXCEPTION_FRAME);
+        flags_print(m_funcs[main_index].chain_flags |
+                    ((handler_max >= 0) ? m_funcs[handler_max].chain_flags : 0));
+        printf("\n");
+    }
+
+    free(p_roots);
+    return 0;
+}
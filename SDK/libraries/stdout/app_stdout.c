@@ -0,0 +1,191 @@
+/** @file
+ *
+ * @defgroup app_stdout Standard output routing
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Single newlib syscall layer routing stdout/stderr to RTT, UART, both or nowhere.
+ */
+
+#include "app_stdout.h"
+#include <stdio.h>
+#include <string.h>
+#include "app_uart.h"
+#include "nordic_common.h"
+#include "nrf_error.h"
+#include "SEGGER_RTT.h"
+#ifdef CRASH_LOG_ENABLED
+#include "crash_log.h"
+#endif
+
+#define STDOUT_FILENO   1
+#define STDERR_FILENO   2
+
+static char     m_line_buf[APP_STDOUT_LINE_SIZE];       /**< newlib stdout buffer. */
+static char     m_uart_buf[APP_STDOUT_UART_BUF_SIZE];   /**< Bytes waiting for room in the UART TX FIFO. */
+static uint32_t m_uart_len;                             /**< Number of bytes in m_uart_buf. */
+static uint32_t m_uart_dropped;                         /**< Bytes dropped by the UART sink. */
+static uint32_t m_rtt_dropped;                          /**< Bytes dropped by the RTT sink. */
+static uint8_t  m_sinks;                                /**< Selected APP_STDOUT_SINK_* flags. */
+
+
+static void rtt_sink_write(char const * p_data, uint32_t length)
+{
+    m_rtt_dropped += length - (uint32_t)SEGGER_RTT_Write(0, p_data, length);
+}
+
+
+/**@brief Function for moving as many buffered bytes as possible to the UART TX FIFO.
+ */
+static void uart_sink_drain(void)
+{
+    uint32_t sent = 0;
+
+    while ((sent < m_uart_len) && (app_uart_put((uint8_t)m_uart_buf[sent]) == NRF_SUCCESS))
+    {
+        sent++;
+    }
+    if (sent != 0)
+    {
+        m_uart_len -= sent;
+        memmove(m_uart_buf, &m_uart_buf[sent], m_uart_len);
+    }
+}
+
+
+static void uart_sink_write(char const * p_data, uint32_t length)
+{
+    // Keep the order: older buffered bytes must go first.
+    if (m_uart_len != 0)
+    {
+        uart_sink_drain();
+    }
+    if (m_uart_len == 0)
+    {
+        while ((length != 0) && (app_uart_put((uint8_t)*p_data) == NRF_SUCCESS))
+        {
+            p_data++;
+            length--;
+        }
+    }
+    if (length > APP_STDOUT_UART_BUF_SIZE - m_uart_len)
+    {
+        m_uart_dropped += length - (APP_STDOUT_UART_BUF_SIZE - m_uart_len);
+        length          = APP_STDOUT_UART_BUF_SIZE - m_uart_len;
+    }
+    memcpy(&m_uart_buf[m_uart_len], p_data, length);
+    m_uart_len += length;
+}
+
+
+uint32_t app_stdout_init(uint8_t sinks)
+{
+    if ((sinks & ~APP_STDOUT_SINK_BOTH) != 0)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    m_sinks        = sinks;
+    m_uart_len     = 0;
+    m_uart_dropped = 0;
+    m_rtt_dropped  = 0;
+
+    // Must be the first operation on stdout.
+    (void)setvbuf(stdout, m_line_buf, _IOLBF, sizeof(m_line_buf));
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_stdout_sinks_set(uint8_t sinks)
+{
+    if ((sinks & ~APP_STDOUT_SINK_BOTH) != 0)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    app_stdout_flush();
+    m_sinks = sinks;
+
+    return NRF_SUCCESS;
+}
+
+
+uint8_t app_stdout_sinks_get(void)
+{
+    return m_sinks;
+}
+
+
+void app_stdout_flush(void)
+{
+    (void)fflush(stdout);
+
+    if ((m_sinks & APP_STDOUT_SINK_UART) && (m_uart_len != 0))
+    {
+        uart_sink_drain();
+    }
+}
+
+
+uint32_t app_stdout_dropped_get(uint8_t sink)
+{
+    switch (sink)
+    {
+        case APP_STDOUT_SINK_RTT:
+            return m_rtt_dropped;
+
+        case APP_STDOUT_SINK_UART:
+            return m_uart_dropped;
+
+        default:
+            return 0;
+    }
+}
+
+
+#if defined(__GNUC__)
+
+int _write(int file, const char * p_char, int len)
+{
+    if ((file != STDOUT_FILENO) && (file != STDERR_FILENO))
+    {
+        return -1;
+    }
+
+    if (m_sinks & APP_STDOUT_SINK_RTT)
+    {
+        rtt_sink_write(p_char, (uint32_t)len);
+    }
+#ifdef CRASH_LOG_ENABLED
+    else
+    {
+        // RTT mirrors into the crash log itself; do it here when RTT is not a sink.
+        crash_log_write(p_char, (uint32_t)len);
+    }
+#endif
+    if (m_sinks & APP_STDOUT_SINK_UART)
+    {
+        uart_sink_write(p_char, (uint32_t)len);
+    }
+
+    return len;
+}
+
+
+int _read(int file, char * p_char, int len)
+{
+    UNUSED_PARAMETER(file);
+    UNUSED_PARAMETER(len);
+
+    while (app_uart_get((uint8_t *)p_char) == NRF_ERROR_NOT_FOUND)
+    {
+        // No implementation needed.
+    }
+
+    return 1;
+}
+
+#endif // defined(__GNUC__)
+
+/** @} */
@@ -0,0 +1,90 @@
+/** @file
+ *
+ * @defgroup app_stdout Standard output routing
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Single newlib syscall layer routing stdout/stderr to RTT, UART, both or nowhere.
+ *
+ * @details This module provides the _write() and _read() system calls used by newlib, and
+ *          replaces both retarget.c and RTT_Syscalls_GCC.c; link only one of the three.
+ *          printf() formats its output once into a static line buffer handed to newlib with
+ *          setvbuf(), so newlib neither allocates its default BUFSIZ (1 KiB) buffer on the heap
+ *          nor calls _write() for every character. Each completed line is then copied to every
+ *          selected sink, which buffers it the way its transport needs:
+ *          - RTT: stored in up-buffer 0 with a single SEGGER_RTT_Write(); the up-buffer is the
+ *            sink buffer.
+ *          - UART: bytes that do not fit into the app_uart TX FIFO are kept in a sink buffer
+ *            and retried on the next write or @ref app_stdout_flush instead of being lost.
+ *
+ *          Bytes a sink cannot take are dropped and counted, see @ref app_stdout_dropped_get.
+ *          stderr is not buffered by newlib and is pushed to the sinks on every write.
+ *
+ *          stdin is read from the UART, as with retarget.c.
+ *
+ * @note    The functions must only be called from thread (main) context.
+ */
+
+#ifndef APP_STDOUT_H__
+#define APP_STDOUT_H__
+
+#include <stdint.h>
+
+#define APP_STDOUT_SINK_NONE    0x00                                            /**< Output is discarded. */
+#define APP_STDOUT_SINK_RTT     0x01                                            /**< Output goes to RTT up-buffer 0. */
+#define APP_STDOUT_SINK_UART    0x02                                            /**< Output goes to app_uart. */
+#define APP_STDOUT_SINK_BOTH    (APP_STDOUT_SINK_RTT | APP_STDOUT_SINK_UART)    /**< Output is copied to RTT and UART. */
+
+#ifndef APP_STDOUT_LINE_SIZE
+#define APP_STDOUT_LINE_SIZE        64  /**< Size of the stdout line buffer given to newlib. */
+#endif
+
+#ifndef APP_STDOUT_UART_BUF_SIZE
+#define APP_STDOUT_UART_BUF_SIZE    64  /**< Size of the UART sink buffer. */
+#endif
+
+/**@brief Function for initializing stdout routing.
+ *
+ * @param[in] sinks  Initial set of sinks, a combination of APP_STDOUT_SINK_* flags.
+ *
+ * @retval NRF_SUCCESS              If stdout routing was initialized.
+ * @retval NRF_ERROR_INVALID_PARAM  If sinks contains unknown flags.
+ */
+uint32_t app_stdout_init(uint8_t sinks);
+
+/**@brief Function for selecting the sinks receiving stdout and stderr.
+ *
+ * @details Pending output is flushed to the previously selected sinks first.
+ *
+ * @param[in] sinks  Combination of APP_STDOUT_SINK_* flags.
+ *
+ * @retval NRF_SUCCESS              If the sinks were selected.
+ * @retval NRF_ERROR_INVALID_PARAM  If sinks contains unknown flags.
+ */
+uint32_t app_stdout_sinks_set(uint8_t sinks);
+
+/**@brief Function for getting the currently selected sinks.
+ *
+ * @return Combination of APP_STDOUT_SINK_* flags.
+ */
+uint8_t app_stdout_sinks_get(void);
+
+/**@brief Function for flushing the buffers of all selected sinks.
+ *
+ * @details Flushes the newlib stdout buffer, then retries the bytes the UART sink is holding
+ *          because they did not fit into the TX FIFO yet. Calling this function periodically
+ *          (e.g. from the main loop) moves them on as the FIFO drains.
+ */
+void app_stdout_flush(void);
+
+/**@brief Function for getting the number of bytes dropped by a sink because its buffer was full.
+ *
+ * @param[in] sink  APP_STDOUT_SINK_RTT or APP_STDOUT_SINK_UART.
+ *
+ * @return Number of bytes the sink dropped since initialization.
+ */
+uint32_t app_stdout_dropped_get(uint8_t sink);
+
+#endif // APP_STDOUT_H__
+
+/** @} */
@@ -0,0 +1,492 @@
+/** @file
+ *
+ * @defgroup app_timer Application Timer
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Single-shot and repeating software timers sharing RTC1.
+ */
+
+#include "app_timer.h"
+#include <stddef.h>
+#include "nrf.h"
+#include "nrf_error.h"
+#include "nrf_drv_common.h"
+#include "nrf_delay.h"
+#include "app_irq_prof.h"
+#include "app_util_platform.h"
+#ifdef SOFTDEVICE_PRESENT
+#include "nrf_sdm.h"
+#endif
+
+STATIC_ASSERT(APP_TIMER_MAX_RUNNING < 0xFF);
+
+#define RTC_COUNTER_MASK    0x00FFFFFF      /**< RTC counter and compare registers are 24 bits wide. */
+#define RTC_CC_MAX_AHEAD    0x00800000      /**< Furthest CC[0] is programmed ahead; later expiries take several compares. */
+#define RTC_CC_MIN_AHEAD    2               /**< CC[0] must be at least COUNTER + 2 to be sure to fire. */
+#define HEAP_INDEX_INVALID  0xFF            /**< heap_index of a timer which is not running. */
+#define DELAY_CC            1               /**< Compare register waking @ref app_timer_delay_us. */
+#define US_PER_512_TICKS    15625           /**< 512 ticks of 32768 Hz are exactly 15625 us. */
+
+static app_timer_t * m_heap[APP_TIMER_MAX_RUNNING];     /**< Running timers, m_heap[0] expires first. */
+static uint8_t       m_heap_size;                       /**< Number of running timers. */
+static uint32_t      m_overflows;                       /**< Number of RTC1 counter overflows, modulo 2^8. */
+static bool          m_started;                         /**< RTC1 was started by app_timer_init(). */
+
+
+/**@brief Function for comparing two expiry times which are less than 2^31 ticks apart. */
+static __INLINE bool expires_before(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) < 0;
+}
+
+
+/**@brief Function for getting the 32-bit extended counter.
+ *
+ * @details Must be called with the RTC1 interrupt blocked. An overflow the interrupt has not
+ *          counted yet is detected through the pending event; the event is read before and
+ *          after the counter so that an overflow in between is not missed.
+ */
+static uint32_t ticks_now(void)
+{
+    uint32_t overflowed;
+    uint32_t counter;
+
+    do
+    {
+        overflowed = NRF_RTC1->EVENTS_OVRFLW;
+        counter    = NRF_RTC1->COUNTER;
+    } while (overflowed != NRF_RTC1->EVENTS_OVRFLW);
+
+    return ((m_overflows + (overflowed ? 1 : 0)) << 24) | counter;
+}
+
+
+static void heap_place(app_timer_t * p_timer, uint8_t index)
+{
+    m_heap[index]       = p_timer;
+    p_timer->heap_index = index;
+}
+
+
+static void heap_sift_up(app_timer_t * p_timer, uint8_t index)
+{
+    uint8_t parent;
+
+    while (index > 0)
+    {
+        parent = (index - 1) >> 1;
+        if (!expires_before(p_timer->expiry, m_heap[parent]->expiry))
+        {
+            break;
+        }
+        heap_place(m_heap[parent], index);
+        index = parent;
+    }
+    heap_place(p_timer, index);
+}
+
+
+static void heap_sift_down(app_timer_t * p_timer, uint8_t index)
+{
+    uint8_t child;
+
+    for (;;)
+    {
+        child = (uint8_t)((index << 1) + 1);
+        if (child >= m_heap_size)
+        {
+            break;
+        }
+        if ((child + 1 < m_heap_size) &&
+            expires_before(m_heap[child + 1]->expiry, m_heap[child]->expiry))
+        {
+            child++;
+        }
+        if (!expires_before(m_heap[child]->expiry, p_timer->expiry))
+        {
+            break;
+        }
+        heap_place(m_heap[child], index);
+        index = child;
+    }
+    heap_place(p_timer, index);
+}
+
+
+static void heap_insert(app_timer_t * p_timer)
+{
+    heap_sift_up(p_timer, m_heap_size++);
+}
+
+
+static void heap_remove(app_timer_t * p_timer)
+{
+    uint8_t       index = p_timer->heap_index;
+    app_timer_t * p_last;
+
+    p_timer->heap_index = HEAP_INDEX_INVALID;
+    p_last              = m_heap[--m_heap_size];
+    if (p_last == p_timer)
+    {
+        return;
+    }
+
+    // Move the last timer into the hole; it may belong above or below it.
+    if ((index > 0) && expires_before(p_last->expiry, m_heap[(index - 1) >> 1]->expiry))
+    {
+        heap_sift_up(p_last, index);
+    }
+    else
+    {
+        heap_sift_down(p_last, index);
+    }
+}
+
+
+/**@brief Function for programming CC[0] for the first timer in the heap.
+ *
+ * @retval true   If the compare event is guaranteed to fire before or at the expiry.
+ * @retval false  If the expiry is too close to be programmed; the caller must check again.
+ */
+static bool rtc_compare_set(uint32_t expiry)
+{
+    uint32_t now   = ticks_now();
+    uint32_t ahead = expiry - now;
+    uint32_t cc;
+
+    if (ahead > RTC_CC_MAX_AHEAD)
+    {
+        ahead = RTC_CC_MAX_AHEAD;
+    }
+    if (ahead < RTC_CC_MIN_AHEAD)
+    {
+        return false;
+    }
+
+    cc                          = (now + ahead) & RTC_COUNTER_MASK;
+    NRF_RTC1->EVENTS_COMPARE[0] = 0;
+    NRF_RTC1->CC[0]             = cc;
+
+    // The counter may have moved on while CC[0] was written.
+    return ((cc - NRF_RTC1->COUNTER) & RTC_COUNTER_MASK) - RTC_CC_MIN_AHEAD < ahead;
+}
+
+
+/**@brief Function for expiring due timers and programming the next expiry.
+ *
+ * @details Timeout handlers are called outside the critical region, so they may start and stop
+ *          timers, including their own.
+ */
+static void timers_process(void)
+{
+    app_timer_timeout_handler_t handler;
+    void *                      p_context;
+    app_timer_t *               p_timer;
+    uint32_t                    now;
+    bool                        done;
+
+    for (;;)
+    {
+        handler   = NULL;
+        p_context = NULL;
+        done      = true;
+
+        CRITICAL_REGION_ENTER();
+        if (m_heap_size != 0)
+        {
+            p_timer = m_heap[0];
+            now     = ticks_now();
+            if (!expires_before(now, p_timer->expiry))
+            {
+                heap_remove(p_timer);
+                if (p_timer->mode == APP_TIMER_MODE_REPEATED)
+                {
+                    // Stay on the original grid, unless whole periods were missed.
+                    p_timer->expiry += p_timer->period;
+                    if (!expires_before(now, p_timer->expiry))
+                    {
+                        p_timer->expiry = now + p_timer->period;
+                    }
+                    heap_insert(p_timer);
+                }
+                handler   = p_timer->handler;
+                p_context = p_timer->p_context;
+                done      = false;
+            }
+            else
+            {
+                done = rtc_compare_set(p_timer->expiry);
+            }
+        }
+        CRITICAL_REGION_EXIT();
+
+        if (handler != NULL)
+        {
+            handler(p_context);
+        }
+        else if (done)
+        {
+            break;
+        }
+    }
+}
+
+
+static bool softdevice_enabled(void)
+{
+#ifdef SOFTDEVICE_PRESENT
+    uint8_t enabled;
+
+    return (sd_softdevice_is_enabled(&enabled) == NRF_SUCCESS) && (enabled != 0);
+#else
+    return false;
+#endif
+}
+
+
+uint32_t app_timer_init(void)
+{
+    if (!softdevice_enabled() &&
+        ((NRF_CLOCK->LFCLKSTAT & CLOCK_LFCLKSTAT_STATE_Msk) !=
+         (CLOCK_LFCLKSTAT_STATE_Running << CLOCK_LFCLKSTAT_STATE_Pos)))
+    {
+        NRF_CLOCK->LFCLKSRC            = (APP_TIMER_LFCLK_SRC << CLOCK_LFCLKSRC_SRC_Pos);
+        NRF_CLOCK->EVENTS_LFCLKSTARTED = 0;
+        NRF_CLOCK->TASKS_LFCLKSTART    = 1;
+    }
+
+    m_heap_size = 0;
+    m_overflows = 0;
+
+    NRF_RTC1->TASKS_STOP        = 1;
+    NRF_RTC1->TASKS_CLEAR       = 1;
+    NRF_RTC1->PRESCALER         = 0;
+    NRF_RTC1->EVENTS_COMPARE[0] = 0;
+    NRF_RTC1->EVENTS_OVRFLW     = 0;
+    NRF_RTC1->EVTENSET          = RTC_EVTEN_COMPARE0_Msk | RTC_EVTEN_OVRFLW_Msk;
+    NRF_RTC1->INTENSET          = RTC_INTENSET_COMPARE0_Msk | RTC_INTENSET_OVRFLW_Msk;
+    nrf_drv_common_irq_enable(RTC1_IRQn, APP_IRQ_PRIORITY_LOW);
+    NRF_RTC1->TASKS_START       = 1;
+    m_started                   = true;
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_timer_create(app_timer_id_t const *      p_timer_id,
+                          app_timer_mode_t            mode,
+                          app_timer_timeout_handler_t timeout_handler)
+{
+    app_timer_t * p_timer;
+
+    if ((p_timer_id == NULL) || (*p_timer_id == NULL) || (timeout_handler == NULL))
+    {
+        return NRF_ERROR_NULL;
+    }
+    p_timer = *p_timer_id;
+
+    // Timers defined with APP_TIMER_DEF are zeroed, so only a created timer can be running.
+    if ((p_timer->handler != NULL) && (p_timer->heap_index != HEAP_INDEX_INVALID))
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    p_timer->handler    = timeout_handler;
+    p_timer->mode       = (uint8_t)mode;
+    p_timer->heap_index = HEAP_INDEX_INVALID;
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_timer_start(app_timer_id_t timer_id, uint32_t timeout_ticks, void * p_context)
+{
+    uint32_t err_code = NRF_SUCCESS;
+    bool     first;
+
+    if ((timeout_ticks == 0) || (timeout_ticks > APP_TIMER_MAX_TICKS))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    CRITICAL_REGION_ENTER();
+    if (timer_id->heap_index != HEAP_INDEX_INVALID)
+    {
+        heap_remove(timer_id);
+    }
+    if (m_heap_size < APP_TIMER_MAX_RUNNING)
+    {
+        timer_id->expiry    = ticks_now() + timeout_ticks;
+        timer_id->period    = timeout_ticks;
+        timer_id->p_context = p_context;
+        heap_insert(timer_id);
+    }
+    else
+    {
+        err_code = NRF_ERROR_NO_MEM;
+    }
+    first = (m_heap_size != 0) && (m_heap[0] == timer_id);
+    CRITICAL_REGION_EXIT();
+
+    // Let the interrupt reprogram CC[0] if this timer now expires first.
+    if (first)
+    {
+        NVIC_SetPendingIRQ(RTC1_IRQn);
+    }
+
+    return err_code;
+}
+
+
+uint32_t app_timer_stop(app_timer_id_t timer_id)
+{
+    // A stale CC[0] for a stopped first timer only causes a spurious interrupt.
+    CRITICAL_REGION_ENTER();
+    if (timer_id->heap_index != HEAP_INDEX_INVALID)
+    {
+        heap_remove(timer_id);
+    }
+    CRITICAL_REGION_EXIT();
+
+    return NRF_SUCCESS;
+}
+
+
+bool app_timer_is_running(app_timer_id_t timer_id)
+{
+    return timer_id->heap_index != HEAP_INDEX_INVALID;
+}
+
+
+uint32_t app_timer_next_expiry_get(uint32_t * p_ticks)
+{
+    uint32_t err_code = NRF_ERROR_NOT_FOUND;
+    uint32_t ahead;
+
+    CRITICAL_REGION_ENTER();
+    if (m_heap_size != 0)
+    {
+        ahead    = m_heap[0]->expiry - ticks_now();
+        *p_ticks = ((int32_t)ahead > 0) ? ahead : 0;
+        err_code = NRF_SUCCESS;
+    }
+    CRITICAL_REGION_EXIT();
+
+    return err_code;
+}
+
+
+uint32_t app_timer_cnt_get(uint32_t * p_ticks)
+{
+    *p_ticks = NRF_RTC1->COUNTER;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_timer_cnt_diff_compute(uint32_t ticks_to, uint32_t ticks_from, uint32_t * p_ticks_diff)
+{
+    *p_ticks_diff = (ticks_to - ticks_from) & RTC_COUNTER_MASK;
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Function for sleeping from one RTC1 tick edge until ticks more have been counted.
+ *
+ * @details The wait ends on the counter value, so WFE returning for any other event only costs
+ *          one more pass. A compare between the check and WFE has set the event register by
+ *          its interrupt entry, or by SEVONPEND while the interrupt cannot preempt, so WFE
+ *          returns at once.
+ */
+static void delay_sleep(uint32_t start, uint32_t ticks)
+{
+    if (ticks >= RTC_CC_MIN_AHEAD)
+    {
+        NRF_RTC1->EVENTS_COMPARE[DELAY_CC] = 0;
+        NRF_RTC1->CC[DELAY_CC]             = (start + ticks) & RTC_COUNTER_MASK;
+        NRF_RTC1->INTENSET                 = RTC_INTENSET_COMPARE1_Msk;
+    }
+
+    while (((NRF_RTC1->COUNTER - start) & RTC_COUNTER_MASK) < ticks)
+    {
+        if (ticks >= RTC_CC_MIN_AHEAD)
+        {
+            __WFE();
+        }
+    }
+
+    NRF_RTC1->INTENCLR                 = RTC_INTENCLR_COMPARE1_Msk;
+    NRF_RTC1->EVENTS_COMPARE[DELAY_CC] = 0;
+}
+
+
+void app_timer_delay_us(uint32_t us)
+{
+    uint32_t ticks;
+    uint32_t rest;
+    uint32_t chunk;
+    uint32_t start;
+
+    // Without a counting RTC1 the wait for the next tick would never end. CC[1] is not shared
+    // between nested delays, so only thread mode sleeps.
+    if ((us < APP_TIMER_DELAY_SLEEP_MIN_US) || !m_started || (__get_IPSR() != 0) ||
+        ((NRF_CLOCK->LFCLKSTAT & CLOCK_LFCLKSTAT_STATE_Msk) !=
+         (CLOCK_LFCLKSTAT_STATE_Running << CLOCK_LFCLKSTAT_STATE_Pos)))
+    {
+        if (us != 0)
+        {
+            nrf_delay_us(us);
+        }
+        return;
+    }
+
+    // us * 512 / 15625 in 32 bits; the remainder is kept in 1/512 us.
+    ticks = (us / US_PER_512_TICKS) * 512;
+    rest  = (us % US_PER_512_TICKS) * 512;
+    ticks += rest / US_PER_512_TICKS;
+    rest   = (rest % US_PER_512_TICKS) / 512;
+
+    SCB->SCR |= SCB_SCR_SEVONPEND_Msk;
+
+    // Start on a tick edge so that whole ticks are whole.
+    start = NRF_RTC1->COUNTER;
+    while (NRF_RTC1->COUNTER == start)
+    {
+    }
+    start = (start + 1) & RTC_COUNTER_MASK;
+
+    while (ticks != 0)
+    {
+        chunk  = MIN(ticks, RTC_CC_MAX_AHEAD);
+        delay_sleep(start, chunk);
+        start  = (start + chunk) & RTC_COUNTER_MASK;
+        ticks -= chunk;
+    }
+
+    if (rest != 0)
+    {
+        nrf_delay_us(rest);
+    }
+}
+
+
+/**@brief RTC1 interrupt handler, counting overflows and expiring timers.
+ */
+void RTC1_IRQHandler(void)
+{
+    APP_IRQ_PROF_ENTER(RTC1_IRQn);
+
+    if (NRF_RTC1->EVENTS_OVRFLW != 0)
+    {
+        NRF_RTC1->EVENTS_OVRFLW = 0;
+        m_overflows++;
+    }
+    NRF_RTC1->EVENTS_COMPARE[0]        = 0;
+    NRF_RTC1->EVENTS_COMPARE[DELAY_CC] = 0;
+
+    timers_process();
+
+    APP_IRQ_PROF_EXIT();
+}
+
+/** @} */
@@ -0,0 +1,196 @@
+/** @file
+ *
+ * @defgroup app_timer Application Timer
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Single-shot and repeating software timers sharing RTC1.
+ *
+ * @details RTC1 runs from the 32.768 kHz LFCLK with prescaler 0, so one tick is about 30.5 us.
+ *          Its 24-bit counter is extended to 32 bits by counting overflows, which lets a timer
+ *          run for up to 2^31 ticks (about 18 hours).
+ *
+ *          Running timers are kept in a binary min-heap ordered by expiry time. Each timer
+ *          remembers its position in the heap, so starting, stopping and expiring a timer are
+ *          O(log n), and only the nearest expiry is programmed into RTC1 CC[0]. Timers are
+ *          allocated statically with @ref APP_TIMER_DEF; the heap holds at most
+ *          @ref APP_TIMER_MAX_RUNNING pointers.
+ *
+ *          Timeout handlers are called from the RTC1 interrupt at APP_IRQ_PRIORITY_LOW. Handlers
+ *          with more work to do should put it into the scheduler (see @ref app_scheduler).
+ *
+ *          @ref app_timer_delay_us sleeps through busy waits on RTC1 CC[1], which no timer uses.
+ *
+ * @note    The functions must not be called from interrupts with a priority above
+ *          APP_IRQ_PRIORITY_LOW. RTC1 and its interrupt handler are owned by this module, which
+ *          is why RTC1_ENABLED stays 0 in nrf_drv_config.h.
+ */
+
+#ifndef APP_TIMER_H__
+#define APP_TIMER_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "nordic_common.h"
+#include "app_util.h"
+
+#ifndef APP_TIMER_MAX_RUNNING
+#define APP_TIMER_MAX_RUNNING   8                       /**< Number of timers that can run at the same time. */
+#endif
+
+#ifndef APP_TIMER_LFCLK_SRC
+#define APP_TIMER_LFCLK_SRC     CLOCK_LFCLKSRC_SRC_Xtal /**< LFCLK source used when the SoftDevice is not running. */
+#endif
+
+#ifndef APP_TIMER_DELAY_SLEEP_MIN_US
+#define APP_TIMER_DELAY_SLEEP_MIN_US    250             /**< Shortest delay which sleeps; shorter ones are cycle loops. */
+#endif
+
+#define APP_TIMER_CLOCK_FREQ    32768                   /**< Frequency of the RTC1 counter. */
+#define APP_TIMER_MAX_TICKS     0x7FFFFFFF              /**< Longest timeout in ticks. */
+
+/**@brief Converts milliseconds to timer ticks, rounded to the nearest tick. */
+#define APP_TIMER_TICKS(MS)     ((uint32_t)ROUNDED_DIV((uint64_t)(MS) * APP_TIMER_CLOCK_FREQ, 1000))
+
+/**@brief Converts timer ticks to milliseconds, rounded down. */
+#define APP_TIMER_MS(TICKS)     ((uint32_t)(((uint64_t)(TICKS) * 1000) / APP_TIMER_CLOCK_FREQ))
+
+/**@brief Timeout handler type.
+ *
+ * @param[in] p_context  Context given to @ref app_timer_start.
+ */
+typedef void (*app_timer_timeout_handler_t)(void * p_context);
+
+/**@brief Timer modes. */
+typedef enum
+{
+    APP_TIMER_MODE_SINGLE_SHOT,     /**< The timer expires once. */
+    APP_TIMER_MODE_REPEATED         /**< The timer restarts itself each time it expires. */
+} app_timer_mode_t;
+
+/**@brief Timer instance. The fields are internal to the module. */
+typedef struct
+{
+    uint32_t                    expiry;         /**< Extended counter value at which the timer expires. */
+    uint32_t                    period;         /**< Reload value in ticks for repeating timers. */
+    app_timer_timeout_handler_t handler;        /**< Timeout handler. */
+    void *                      p_context;      /**< Context passed to the handler. */
+    uint8_t                     heap_index;     /**< Position in the heap, or 0xFF if the timer is not running. */
+    uint8_t                     mode;           /**< app_timer_mode_t. */
+} app_timer_t;
+
+/**@brief Timer ID type. */
+typedef app_timer_t * app_timer_id_t;
+
+/**@brief Macro for defining a timer instance and its ID.
+ *
+ * @param[in] timer_id  Name of the timer ID variable.
+ */
+#define APP_TIMER_DEF(timer_id)                                     \
+    static app_timer_t CONCAT_2(timer_id, _data);                   \
+    static const app_timer_id_t timer_id = &CONCAT_2(timer_id, _data)
+
+/**@brief Function for initializing the timer module and starting RTC1.
+ *
+ * @details If the SoftDevice is not running, LFCLK is started from @ref APP_TIMER_LFCLK_SRC. The
+ *          counter runs as soon as the clock is up; there is no wait for it to settle.
+ *
+ * @retval NRF_SUCCESS  If the module was initialized.
+ */
+uint32_t app_timer_init(void);
+
+/**@brief Function for creating a timer.
+ *
+ * @param[in] p_timer_id        ID of a timer defined with @ref APP_TIMER_DEF.
+ * @param[in] mode              Single-shot or repeated.
+ * @param[in] timeout_handler   Handler called when the timer expires.
+ *
+ * @retval NRF_SUCCESS              If the timer was created.
+ * @retval NRF_ERROR_NULL           If a parameter is NULL.
+ * @retval NRF_ERROR_INVALID_STATE  If the timer is running.
+ */
+uint32_t app_timer_create(app_timer_id_t const *      p_timer_id,
+                          app_timer_mode_t            mode,
+                          app_timer_timeout_handler_t timeout_handler);
+
+/**@brief Function for starting a timer. A running timer is restarted.
+ *
+ * @param[in] timer_id       Timer.
+ * @param[in] timeout_ticks  Ticks until the timer expires, and the period of a repeating timer,
+ *                           1 to @ref APP_TIMER_MAX_TICKS.
+ * @param[in] p_context      Context passed to the timeout handler.
+ *
+ * @retval NRF_SUCCESS              If the timer was started.
+ * @retval NRF_ERROR_INVALID_PARAM  If timeout_ticks is out of range.
+ * @retval NRF_ERROR_NO_MEM         If @ref APP_TIMER_MAX_RUNNING timers are running already.
+ */
+uint32_t app_timer_start(app_timer_id_t timer_id, uint32_t timeout_ticks, void * p_context);
+
+/**@brief Function for stopping a timer. Stopping a timer which is not running has no effect.
+ *
+ * @param[in] timer_id  Timer.
+ *
+ * @retval NRF_SUCCESS  If the timer was stopped.
+ */
+uint32_t app_timer_stop(app_timer_id_t timer_id);
+
+/**@brief Function for checking whether a timer is running.
+ *
+ * @param[in] timer_id  Timer.
+ */
+bool app_timer_is_running(app_timer_id_t timer_id);
+
+/**@brief Function for getting the time until the first running timer expires.
+ *
+ * @details Used by the power manager to pick a sleep mode.
+ *
+ * @param[out] p_ticks  Ticks until the expiry, 0 if it is due.
+ *
+ * @retval NRF_SUCCESS          If a timer is running.
+ * @retval NRF_ERROR_NOT_FOUND  If no timer is running; nothing will wake the CPU from RTC1.
+ */
+uint32_t app_timer_next_expiry_get(uint32_t * p_ticks);
+
+/**@brief Function for getting the current value of the RTC1 counter.
+ *
+ * @param[out] p_ticks  24-bit counter value.
+ *
+ * @retval NRF_SUCCESS  If the counter was read.
+ */
+uint32_t app_timer_cnt_get(uint32_t * p_ticks);
+
+/**@brief Function for computing the difference between two RTC1 counter values.
+ *
+ * @param[in]  ticks_to       Later counter value.
+ * @param[in]  ticks_from     Earlier counter value.
+ * @param[out] p_ticks_diff   Ticks elapsed, modulo 2^24.
+ *
+ * @retval NRF_SUCCESS  If the difference was computed.
+ */
+uint32_t app_timer_cnt_diff_compute(uint32_t ticks_to, uint32_t ticks_from, uint32_t * p_ticks_diff);
+
+/**@brief Function for waiting a number of microseconds, sleeping through most of it.
+ *
+ * @details Delays shorter than @ref APP_TIMER_DELAY_SLEEP_MIN_US are nrf_delay_us() cycle loops.
+ *          Longer ones spin to the next RTC1 tick, sleep with WFE until RTC1 CC[1] has counted
+ *          the whole ticks, and spin the remainder of less than a tick. Only the spins depend on
+ *          the CPU clock and flash timing, so the error stays within a few microseconds plus the
+ *          LFCLK tolerance, however long the delay. Interrupts taken meanwhile do not lengthen a
+ *          sleeping delay unless they outlast it.
+ *
+ *          Before @ref app_timer_init, or while the LFCLK is still starting, RTC1 does not count
+ *          and the whole delay is an nrf_delay_us() cycle loop.
+ *
+ *          Unlike a timer, the delay blocks its caller; other interrupts run while it sleeps.
+ *          Only thread mode sleeps: all delays share RTC1 CC[1], so a delay called from an
+ *          interrupt would take the wakeup of the delay it preempted. Called from an interrupt,
+ *          the whole delay is an nrf_delay_us() cycle loop. A sleeping delay also works inside a
+ *          critical region, since the pending RTC1 interrupt still wakes WFE (SEVONPEND is set).
+ *
+ * @param[in] us  Delay in microseconds.
+ */
+void app_timer_delay_us(uint32_t us);
+
+#endif // APP_TIMER_H__
+
+/** @} */
@@ -0,0 +1,38 @@
+/** @file
+ *
+ * @defgroup app_timestamp Timestamps for profiling
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Microsecond timestamps from a free-running TIMER2, for measuring short code sections.
+ */
+
+#include "app_timestamp.h"
+
+void app_timestamp_init(void)
+{
+    NRF_TIMER2->TASKS_STOP  = 1;
+    NRF_TIMER2->MODE        = TIMER_MODE_MODE_Timer << TIMER_MODE_MODE_Pos;
+    NRF_TIMER2->BITMODE     = TIMER_BITMODE_BITMODE_16Bit << TIMER_BITMODE_BITMODE_Pos;
+    NRF_TIMER2->PRESCALER   = 4;                            // 16 MHz / 2^4 = 1 MHz
+    NRF_TIMER2->SHORTS      = 0;
+    NRF_TIMER2->INTENCLR    = 0xFFFFFFFF;
+    NRF_TIMER2->TASKS_CLEAR = 1;
+    NRF_TIMER2->TASKS_START = 1;
+}
+
+
+uint16_t app_timestamp_boot_cycles_get(void)
+{
+    uint16_t cycles;
+
+    NRF_TIMER2->TASKS_CAPTURE[APP_TIMESTAMP_CC] = 1;
+    cycles = (uint16_t)NRF_TIMER2->CC[APP_TIMESTAMP_CC];
+
+    NRF_TIMER2->TASKS_STOP     = 1;
+    NRF_TIMER2->TASKS_SHUTDOWN = 1;
+
+    return cycles;
+}
+
+/** @} */
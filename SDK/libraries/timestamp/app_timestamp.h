@@ -0,0 +1,60 @@
+/** @file
+ *
+ * @defgroup app_timestamp Timestamps for profiling
+ * @{
+ * @ingroup app_common
+ *
+ * @brief Microsecond timestamps from a free-running TIMER2, for measuring short code sections.
+ *
+ * @details TIMER2 is 16 bits wide on nRF51 and runs at 1 MHz, so differences between two
+ *          timestamps are valid for sections up to 65 ms. A timestamp taken in an interrupt that
+ *          preempts another @ref app_timestamp_get between its capture and its read may shift
+ *          that reading by the length of the interrupt.
+ *
+ * @note    The running timer keeps HFCLK requested, which raises the sleep current. Enable it for
+ *          profiling builds only.
+ */
+
+#ifndef APP_TIMESTAMP_H__
+#define APP_TIMESTAMP_H__
+
+#include <stdint.h>
+#include "nrf.h"
+
+#define APP_TIMESTAMP_CC    3   /**< TIMER2 capture register used by @ref app_timestamp_get. */
+
+/**@brief Function for starting the timestamp timer. */
+void app_timestamp_init(void);
+
+/**@brief Function for getting the time spent between the reset handler and the call.
+ *
+ * @details With __STARTUP_BOOT_TIME defined for the startup file, Reset_Handler starts TIMER2 at
+ *          16 MHz before it initializes RAM. This function reads the timer, then stops it to
+ *          release HFCLK. Call it first in main; the count wraps after 4.1 ms.
+ *
+ * @return CPU cycles since Reset_Handler, or 0 if the startup file did not start the timer.
+ */
+uint16_t app_timestamp_boot_cycles_get(void);
+
+/**@brief Function for getting the current timestamp.
+ *
+ * @return Time in microseconds, modulo 2^16.
+ */
+static __INLINE uint16_t app_timestamp_get(void)
+{
+    NRF_TIMER2->TASKS_CAPTURE[APP_TIMESTAMP_CC] = 1;
+    return (uint16_t)NRF_TIMER2->CC[APP_TIMESTAMP_CC];
+}
+
+/**@brief Function for getting the microseconds elapsed since a timestamp.
+ *
+ * @param[in] start  Timestamp taken at the start of the section.
+ */
+static __INLINE uint16_t app_timestamp_elapsed(uint16_t start)
+{
+    return (uint16_t)(app_timestamp_get() - start);
+}
+
+#endif // APP_TIMESTAMP_H__
+
+/** @} */
@@ -221,6 +221,40 @@ uint32_t app_uart_flush(void);
  */
 uint32_t app_uart_close(void);
 
+#ifdef APP_UART_ISR_PROFILE
+/**@brief Function for getting the longest time spent in the UART event handler, i.e. in interrupt
+ *        context, since the last call (Only valid if FIFO is used).
+ *
+ * @details Requires app_timestamp_init() to have been called. Build with and without
+ *          APP_UART_WITH_SCHEDULER to compare handling the application events in the interrupt
+ *          with deferring them to thread mode.
+ *
+ * @return  Longest time in microseconds. The value is reset by this call.
+ */
+uint16_t app_uart_isr_time_max_get(void);
+#endif
+
+#ifdef APP_UART_WITH_SCHEDULER
+/**@brief Function for delivering an APP_UART_DATA_READY event which did not fit into the
+ *        scheduler queue.
+ *
+ * @details The bytes of a dropped APP_UART_DATA_READY stay in the RX FIFO, and reception stops
+ *          once it is full, as usual. Call this from thread mode after app_sched_execute(); it
+ *          calls the event handler if such an event is owed. The queue was full when the event
+ *          was dropped, so the main loop does not sleep before calling this again.
+ */
+void app_uart_evt_pending_process(void);
+
+/**@brief Function for getting the number of events dropped because the scheduler queue was full.
+ *
+ * @details A dropped event is not handed to the application from the interrupt instead. A
+ *          dropped APP_UART_DATA_READY is delivered by @ref app_uart_evt_pending_process.
+ *
+ * @return  Number of events dropped since initialization.
+ */
+uint32_t app_uart_evt_dropped_get(void);
+#endif
+
 
 #endif //APP_UART_H__
 
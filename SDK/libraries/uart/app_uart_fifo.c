@@ -14,6 +14,13 @@
 #include "app_fifo.h"
 #include "nrf_drv_uart.h"
 #include "nrf_assert.h"
+#include "nordic_common.h"
+#ifdef APP_UART_WITH_SCHEDULER
+#include "app_scheduler.h"
+#endif
+#ifdef APP_UART_ISR_PROFILE
+#include "app_timestamp.h"
+#endif
 
 static __INLINE uint32_t fifo_length(app_fifo_t * const fifo)
 {
@@ -31,10 +38,61 @@ static uint8_t rx_buffer[1];
 
 static app_fifo_t                  m_rx_fifo;                               /**< RX FIFO buffer for storing data received on the UART until the application fetches them using app_uart_get(). */
 static app_fifo_t                  m_tx_fifo;                               /**< TX FIFO buffer for storing data to be transmitted on the UART when TXD is ready. Data is put to the buffer on using app_uart_put(). */
+#ifdef APP_UART_ISR_PROFILE
+static uint16_t                    m_isr_time_max;                          /**< Longest time spent in uart_event_handler(), in microseconds. */
+#endif
+#ifdef APP_UART_WITH_SCHEDULER
+static volatile bool               m_rx_notify_pending;                     /**< An APP_UART_DATA_READY event did not fit into the scheduler queue and is owed. */
+static uint32_t                    m_evt_dropped;                           /**< Events which did not fit into the scheduler queue. */
+#endif
 
-static void uart_event_handler(nrf_drv_uart_event_t * p_event, void* p_context)
+#ifdef APP_UART_WITH_SCHEDULER
+static void uart_evt_sched_handler(void * p_event_data, uint16_t event_size)
+{
+    UNUSED_PARAMETER(event_size);
+    m_event_handler((app_uart_evt_t *)p_event_data);
+}
+#endif
+
+/**@brief Function for passing an event to the application.
+ *
+ * @details With APP_UART_WITH_SCHEDULER, the event is copied into the scheduler queue and the
+ *          application handler runs in thread mode. Errors and received data go ahead of normal
+ *          events, the end of a transmission behind them. If the queue is full, the event is
+ *          counted and dropped; the handler is never called from the interrupt, so events stay in
+ *          order and the handler never races with itself.
+ *
+ * @return  false if the event was dropped.
+ */
+__RAMFUNC static bool event_notify(app_uart_evt_t * p_event)
+{
+#ifdef APP_UART_WITH_SCHEDULER
+    app_sched_prio_t prio = APP_SCHED_PRIO_HIGH;
+
+    if (p_event->evt_type == APP_UART_TX_EMPTY)
+    {
+        prio = APP_SCHED_PRIO_LOW;
+    }
+    if (app_sched_event_put_prio(p_event, sizeof(*p_event), uart_evt_sched_handler, prio)
+        != NRF_SUCCESS)
+    {
+        m_evt_dropped++;
+        return false;
+    }
+#else
+    m_event_handler(p_event);
+#endif
+    return true;
+}
+
+// Called for every byte, from UART0_IRQHandler; both run from RAM.
+__RAMFUNC static void uart_event_handler(nrf_drv_uart_event_t * p_event, void* p_context)
 {
     app_uart_evt_t app_uart_event;
+#ifdef APP_UART_ISR_PROFILE
+    uint16_t       start = app_timestamp_get();
+    uint16_t       elapsed;
+#endif
 
     if (p_event->type == NRF_DRV_UART_EVT_RX_DONE)
     {
@@ -44,13 +102,19 @@ static void uart_event_handler(nrf_drv_uart_event_t * p_event, void* p_context)
         {
             app_uart_event.evt_type          = APP_UART_FIFO_ERROR;
             app_uart_event.data.error_code   = err_code;
-            m_event_handler(&app_uart_event);
+            (void)event_notify(&app_uart_event);
         }
         // Notify that new data is available if this was first byte put in the buffer.
         else if (FIFO_LENGTH(m_rx_fifo) == 1)
         {
             app_uart_event.evt_type = APP_UART_DATA_READY;
-            m_event_handler(&app_uart_event);
+            if (!event_notify(&app_uart_event))
+            {
+#ifdef APP_UART_WITH_SCHEDULER
+                // Owed; app_uart_evt_pending_process() delivers it from thread mode.
+                m_rx_notify_pending = true;
+#endif
+            }
         }
         else
         {
@@ -65,7 +129,7 @@ static void uart_event_handler(nrf_drv_uart_event_t * p_event, void* p_context)
     {
         app_uart_event.evt_type                 = APP_UART_COMMUNICATION_ERROR;
         app_uart_event.data.error_communication = p_event->data.error.error_mask;
-        m_event_handler(&app_uart_event);
+        (void)event_notify(&app_uart_event);
     }
     else if (p_event->type == NRF_DRV_UART_EVT_TX_DONE)
     {
@@ -79,9 +143,16 @@ static void uart_event_handler(nrf_drv_uart_event_t * p_event, void* p_context)
             // Last byte from FIFO transmitted, notify the application.
             // Notify that new data is available if this was first byte put in the buffer.
             app_uart_event.evt_type = APP_UART_TX_EMPTY;
-            m_event_handler(&app_uart_event);
+            (void)event_notify(&app_uart_event);
         }
     }
+#ifdef APP_UART_ISR_PROFILE
+    elapsed = app_timestamp_elapsed(start);
+    if (elapsed > m_isr_time_max)
+    {
+        m_isr_time_max = elapsed;
+    }
+#endif
 }
 
 uint32_t app_uart_init(const app_uart_comm_params_t * p_comm_params,
@@ -91,7 +162,10 @@ uint32_t app_uart_init(const app_uart_comm_params_t * p_comm_params,
 {
     uint32_t err_code;
 
-    m_event_handler = event_handler;
+    m_event_handler     = event_handler;
+#ifdef APP_UART_WITH_SCHEDULER
+    m_rx_notify_pending = false;
+#endif
 
     if (p_buffers == NULL)
     {
@@ -185,6 +259,41 @@ uint32_t app_uart_put(uint8_t byte)
     return err_code;
 }
 
+#ifdef APP_UART_ISR_PROFILE
+uint16_t app_uart_isr_time_max_get(void)
+{
+    uint16_t time_max = m_isr_time_max;
+
+    m_isr_time_max = 0;
+    return time_max;
+}
+
+#endif
+
+#ifdef APP_UART_WITH_SCHEDULER
+void app_uart_evt_pending_process(void)
+{
+    app_uart_evt_t app_uart_event;
+    bool           pending;
+
+    CRITICAL_REGION_ENTER();
+    pending             = m_rx_notify_pending;
+    m_rx_notify_pending = false;
+    CRITICAL_REGION_EXIT();
+
+    if (pending)
+    {
+        app_uart_event.evt_type = APP_UART_DATA_READY;
+        m_event_handler(&app_uart_event);
+    }
+}
+
+
+uint32_t app_uart_evt_dropped_get(void)
+{
+    return m_evt_dropped;
+}
+#endif
 uint32_t app_uart_close(void)
 {
     nrf_drv_uart_uninit();
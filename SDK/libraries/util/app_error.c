@@ -23,6 +23,12 @@
 #include "app_error.h"
 #include "compiler_abstraction.h"
 #include "nordic_common.h"
+#ifdef CRASH_LOG_ENABLED
+#include "crash_log.h"
+#endif
+#ifdef APP_FAULT_ENABLED
+#include "app_fault.h"
+#endif
 #ifdef DEBUG
 #include "bsp.h"
 
@@ -48,6 +54,18 @@ const uint8_t * m_p_file_name;
 /*lint -save -e14 */
 __WEAK void app_error_handler(uint32_t error_code, uint32_t line_num, const uint8_t * p_file_name)
 {
+#ifdef APP_FAULT_ENABLED
+    // Does not return: keeps the error and its call site for the next boot, seals the crash log
+    // and resets.
+    app_fault_error_record(error_code, line_num, p_file_name,
+                           (uint32_t)__builtin_return_address(0));
+#endif
+
+#ifdef CRASH_LOG_ENABLED
+    // Let the next boot verify and replay the log output leading up to the error.
+    crash_log_seal();
+#endif
+
     // On assert, the system can only recover with a reset.
 #ifndef DEBUG
     NVIC_SystemReset();
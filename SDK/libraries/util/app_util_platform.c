@@ -14,6 +14,10 @@
 
 static uint32_t m_in_critical_region = 0;
 
+#ifdef SOFTDEVICE_PRESENT
+app_critical_region_state_t app_critical_region_state = {0, 0};
+#endif
+
 void critical_region_enter(void)
 {
     __disable_irq();    
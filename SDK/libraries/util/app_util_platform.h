@@ -29,6 +29,12 @@
 #include "nrf_soc.h"
 #include "app_error.h"
 #endif
+#ifdef APP_CRIT_PROFILE
+#include "app_crit_prof.h"
+#else
+#define APP_CRIT_PROF_ENTER()   /**< Critical regions are not profiled. */
+#define APP_CRIT_PROF_EXIT()    /**< Critical regions are not profiled. */
+#endif
 /**@brief The interrupt priorities available to the application while the SoftDevice is active. */
 typedef enum
 {
@@ -53,29 +59,102 @@ typedef enum
 void critical_region_enter (void);
 void critical_region_exit (void);
 
+#ifdef SOFTDEVICE_PRESENT
+/**@brief Interrupts of the peripherals S110 reserves; they are never masked by
+ *        @ref app_critical_region_enter. */
+#define APP_CRITICAL_REGION_SD_IRQS ((1UL << POWER_CLOCK_IRQn) | (1UL << RADIO_IRQn) |          \
+                                     (1UL << TIMER0_IRQn) | (1UL << RTC0_IRQn) |                \
+                                     (1UL << TEMP_IRQn) | (1UL << RNG_IRQn) |                   \
+                                     (1UL << ECB_IRQn) | (1UL << CCM_AAR_IRQn) |                \
+                                     (1UL << SWI4_IRQn) | (1UL << SWI5_IRQn))
+
+/**@brief Interrupts masked by @ref app_critical_region_enter. */
+#define APP_CRITICAL_REGION_APP_IRQS ((uint32_t)~APP_CRITICAL_REGION_SD_IRQS)
+
+/**@brief State of the outermost critical region. */
+typedef struct
+{
+    uint32_t irq_mask;      /**< Application interrupts which were enabled when it was entered. */
+    uint8_t  active;        /**< A critical region has been entered. */
+} app_critical_region_state_t;
+
+extern app_critical_region_state_t app_critical_region_state;
+
+/**@brief Function for entering a critical region without a SoftDevice call.
+ *
+ * @details Does what sd_nvic_critical_region_enter() does, inline: the enabled application
+ *          interrupts are saved and disabled through NVIC ICER, leaving the interrupts of the
+ *          SoftDevice and PRIMASK alone, as S110 requires. PRIMASK is only set for the few
+ *          instructions which update the saved state, so that an interrupt cannot enter a
+ *          region of its own in between. The reserved interrupts are left enabled whether or
+ *          not the SoftDevice is, so the application must not use those peripherals either way.
+ *
+ * @note    Interrupts enabled or disabled inside the region get back their state from before
+ *          the outermost region when it is left.
+ *
+ * @return 1 if the region is nested in another one, 0 otherwise; pass it to
+ *         @ref app_critical_region_exit.
+ */
+static __INLINE uint8_t app_critical_region_enter(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint8_t  nested;
+
+    __disable_irq();
+    nested = app_critical_region_state.active;
+    if (!nested)
+    {
+        app_critical_region_state.irq_mask = NVIC->ISER[0] & APP_CRITICAL_REGION_APP_IRQS;
+        NVIC->ICER[0]                      = APP_CRITICAL_REGION_APP_IRQS;
+        app_critical_region_state.active   = 1;
+    }
+    if (primask == 0)
+    {
+        __enable_irq();
+    }
+
+    return nested;
+}
+
+/**@brief Function for leaving a critical region entered with @ref app_critical_region_enter.
+ *
+ * @param[in] nested  Value returned when the region was entered.
+ */
+static __INLINE void app_critical_region_exit(uint8_t nested)
+{
+    uint32_t primask;
+
+    if (!nested)
+    {
+        primask = __get_PRIMASK();
+        __disable_irq();
+        app_critical_region_state.active = 0;
+        NVIC->ISER[0]                    = app_critical_region_state.irq_mask;
+        if (primask == 0)
+        {
+            __enable_irq();
+        }
+    }
+}
+#endif // SOFTDEVICE_PRESENT
+
 /**@brief Macro for entering a critical region.
  *
  * @note Due to implementation details, there must exist one and only one call to
  *       CRITICAL_REGION_EXIT() for each call to CRITICAL_REGION_ENTER(), and they must be located
- *       in the same scope.
+ *       in the same scope. With APP_CRIT_PROFILE defined, the time spent in the region is
+ *       recorded per call site, see @ref app_crit_prof.
+ *
+ * @note With the SoftDevice present, application interrupts are masked inline with
+ *       @ref app_critical_region_enter rather than with the sd_nvic_critical_region_enter() SVC.
  */
 #ifdef SOFTDEVICE_PRESENT
 #define CRITICAL_REGION_ENTER()                                                             \
     {                                                                                       \
-        uint8_t IS_NESTED_CRITICAL_REGION = 0;                                              \
-        uint32_t CURRENT_INT_PRI = current_int_priority_get();                              \
-        if (CURRENT_INT_PRI != APP_IRQ_PRIORITY_HIGH)                                       \
-        {                                                                                   \
-            uint32_t ERR_CODE = sd_nvic_critical_region_enter(&IS_NESTED_CRITICAL_REGION);  \
-            if (ERR_CODE == NRF_ERROR_SOFTDEVICE_NOT_ENABLED)                               \
-            {                                                                               \
-                __disable_irq();                                                            \
-            }                                                                               \
-            else                                                                            \
-            {                                                                               \
-                APP_ERROR_CHECK(ERR_CODE);                                                  \
-            }                                                                               \
-        }        
+        uint8_t IS_NESTED_CRITICAL_REGION = app_critical_region_enter();                    \
+        APP_CRIT_PROF_ENTER()
+#elif defined(APP_CRIT_PROFILE)
+#define CRITICAL_REGION_ENTER() { critical_region_enter(); APP_CRIT_PROF_ENTER()
 #else
 #define CRITICAL_REGION_ENTER() critical_region_enter()
 #endif
@@ -88,17 +167,11 @@ void critical_region_exit (void);
  */
 #ifdef SOFTDEVICE_PRESENT
 #define CRITICAL_REGION_EXIT()                                                              \
-        if (CURRENT_INT_PRI != APP_IRQ_PRIORITY_HIGH)                                       \
-        {                                                                                   \
-            uint32_t ERR_CODE;                                                              \
-            __enable_irq();                                                                 \
-            ERR_CODE = sd_nvic_critical_region_exit(IS_NESTED_CRITICAL_REGION);             \
-            if (ERR_CODE != NRF_ERROR_SOFTDEVICE_NOT_ENABLED)                               \
-            {                                                                               \
-                APP_ERROR_CHECK(ERR_CODE);                                                  \
-            }                                                                               \
-        }                                                                                   \
+        APP_CRIT_PROF_EXIT()                                                                \
+        app_critical_region_exit(IS_NESTED_CRITICAL_REGION);                                \
     }
+#elif defined(APP_CRIT_PROFILE)
+#define CRITICAL_REGION_EXIT() APP_CRIT_PROF_EXIT() critical_region_exit(); }
 #else
 #define CRITICAL_REGION_EXIT() critical_region_exit()
 #endif 
@@ -130,6 +130,8 @@ __Vectors:
     .equ    NRF_POWER_RAMON_ADDRESS,             0x40000524
     .equ    NRF_POWER_RAMONB_ADDRESS,            0x40000554
     .equ    NRF_POWER_RAMONx_RAMxON_ONMODE_Msk,  0x3  
+    .equ    NRF_TIMER2_TASKS_START_ADDRESS,      0x4000A000
+    .equ    NRF_TIMER2_PRESCALER_ADDRESS,        0x4000A510
 
     .text
     .thumb
@@ -153,6 +155,52 @@ Reset_Handler:
     ORRS    R2, R1
     STR     R2, [R0]
 
+#ifdef __STARTUP_BOOT_TIME
+/*     Start TIMER2 at 16 MHz, i.e. in CPU cycles, so that main can read the
+ *      time spent from here on with app_timestamp_boot_cycles_get(). */
+
+    LDR     R0, =NRF_TIMER2_PRESCALER_ADDRESS
+    MOVS    R1, #0
+    STR     R1, [R0]
+    LDR     R0, =NRF_TIMER2_TASKS_START_ADDRESS
+    MOVS    R1, #1
+    STR     R1, [R0]
+#endif
+
+/*     The loops below store four words at a time and finish word by word.
+ *      r0 and r4 to r6 hold the data; nothing has been pushed yet, so the
+ *      registers need not be preserved. */
+
+#ifdef __STARTUP_PAINT_STACK
+/*     Fill the stack from __StackLimit up to the current stack pointer with
+ *      0xA5A5A5A5 (APP_STACK_PAINT in app_stack.h). app_stack finds the
+ *      deepest use later as the lowest word which changed. */
+
+    ldr    r1, =__StackLimit
+    mov    r2, sp
+    ldr    r0, =0xA5A5A5A5
+    mov    r4, r0
+    mov    r5, r0
+    mov    r6, r0
+
+    subs   r2, r1
+    ble    .LS0
+    subs   r2, #16
+    blt    .LS2
+.LS1:
+    stmia  r1!, {r0, r4, r5, r6}
+    subs   r2, #16
+    bge    .LS1
+.LS2:
+    adds   r2, #16
+    beq    .LS0
+.LS3:
+    stmia  r1!, {r0}
+    subs   r2, #4
+    bgt    .LS3
+.LS0:
+#endif
+
 /*     Loop to copy data from read only memory to RAM. The ranges
  *      of copy from/to are specified by following symbols evaluated in 
  *      linker script.
@@ -164,19 +212,92 @@ Reset_Handler:
     ldr    r2, =__data_start__
     ldr    r3, =__data_end__
 
-    subs    r3, r2
-    ble     .LC0
-
+    subs   r3, r2
+    ble    .LC0
+    subs   r3, #16
+    blt    .LC2
 .LC1:
-    subs    r3, 4
-    ldr    r0, [r1,r3]
-    str    r0, [r2,r3]
-    bgt    .LC1
+    ldmia  r1!, {r0, r4, r5, r6}
+    stmia  r2!, {r0, r4, r5, r6}
+    subs   r3, #16
+    bge    .LC1
+.LC2:
+    adds   r3, #16
+    beq    .LC0
+.LC3:
+    ldmia  r1!, {r0}
+    stmia  r2!, {r0}
+    subs   r3, #4
+    bgt    .LC3
 .LC0:
-    
+
+/*     Copy the functions marked __RAMFUNC the same way, from __ramfunc_load__
+ *      to __ramfunc_start__/__ramfunc_end__. */
+
+    ldr    r1, =__ramfunc_load__
+    ldr    r2, =__ramfunc_start__
+    ldr    r3, =__ramfunc_end__
+
+    subs   r3, r2
+    ble    .LR0
+    subs   r3, #16
+    blt    .LR2
+.LR1:
+    ldmia  r1!, {r0, r4, r5, r6}
+    stmia  r2!, {r0, r4, r5, r6}
+    subs   r3, #16
+    bge    .LR1
+.LR2:
+    adds   r3, #16
+    beq    .LR0
+.LR3:
+    ldmia  r1!, {r0}
+    stmia  r2!, {r0}
+    subs   r3, #4
+    bgt    .LR3
+.LR0:
+
+#ifdef __STARTUP_CLEAR_BSS
+/*     Zero .bss, between __bss_start__ and __bss_end__, both aligned to 4
+ *      bytes. newlib's _start zeroes it again, byte by byte with the nano
+ *      library; define __START=main as well to skip that. .noinit is left
+ *      alone either way. */
+
+    ldr    r1, =__bss_start__
+    ldr    r2, =__bss_end__
+    movs   r0, #0
+    movs   r4, #0
+    movs   r5, #0
+    movs   r6, #0
+
+    subs   r2, r1
+    ble    .LZ0
+    subs   r2, #16
+    blt    .LZ2
+.LZ1:
+    stmia  r1!, {r0, r4, r5, r6}
+    subs   r2, #16
+    bge    .LZ1
+.LZ2:
+    adds   r2, #16
+    beq    .LZ0
+.LZ3:
+    stmia  r1!, {r0}
+    subs   r2, #4
+    bgt    .LZ3
+.LZ0:
+#endif
+
+/*     newlib's _start sets up the C library and calls main. With .bss
+ *      cleared above, main can be entered directly (__START=main) when no
+ *      C++ constructors or other .init_array entries need to run. */
+#ifndef __START
+#define __START _start
+#endif
+
     LDR     R0, =SystemInit
     BLX     R0
-    LDR     R0, =_start
+    LDR     R0, =__START
     BX      R0
 
     .pool
@@ -0,0 +1,292 @@
+/** @file
+ *
+ * @brief Host report of the flash and RAM taken by each module, from a GNU ld map file.
+ *
+ * @details Reads the map file written with -Map and adds up the input sections of each object
+ *          file by the output section they went to:
+ *          - text: .text, .ARM.extab, .ARM.exidx and .fs_data_out, in flash only;
+ *          - data: .data and .ramfunc, in flash and copied to RAM;
+ *          - bss:  .bss, .noinit, .heap and .stack_dummy, in RAM only.
+ *
+ *          Members of a library count towards the library, e.g. libc_nano.a, unless -m is given.
+ *          Linker veneers count as "linker stubs". Fill between sections is not counted, so the
+ *          totals can be a little below those of arm-none-eabi-size.
+ *
+ *          With -flto the code is compiled again at link time into temporary objects, which
+ *          the map file names instead of the modules; the table then only tells the total.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LINE_SIZE           1024
+#define NAME_SIZE           128
+
+typedef enum
+{
+    CLASS_NONE,             /**< Not loaded: debug information, attributes. */
+    CLASS_TEXT,
+    CLASS_DATA,
+    CLASS_BSS
+} section_class_t;
+
+typedef struct
+{
+    char     name[NAME_SIZE];
+    uint32_t size[4];       /**< Bytes by section_class_t. */
+} module_t;
+
+static module_t * m_modules;
+static uint32_t   m_module_count;
+static bool       m_members;    /**< Report library members on their own. */
+
+
+static section_class_t section_class(const char * p_name)
+{
+    static const char * const text[] = {".text", ".ARM.extab", ".ARM.exidx", ".fs_data_out"};
+    static const char * const data[] = {".data", ".ramfunc"};
+    static const char * const bss[]  = {".bss", ".noinit", ".heap", ".stack_dummy"};
+    uint32_t i;
+
+    for (i = 0; i < sizeof(text) / sizeof(text[0]); i++)
+    {
+        if (strcmp(p_name, text[i]) == 0)
+        {
+            return CLASS_TEXT;
+        }
+    }
+    for (i = 0; i < sizeof(data) / sizeof(data[0]); i++)
+    {
+        if (strcmp(p_name, data[i]) == 0)
+        {
+            return CLASS_DATA;
+        }
+    }
+    for (i = 0; i < sizeof(bss) / sizeof(bss[0]); i++)
+    {
+        if (strcmp(p_name, bss[i]) == 0)
+        {
+            return CLASS_BSS;
+        }
+    }
+    return CLASS_NONE;
+}
+
+
+/**@brief Function for getting the module name of an object file path.
+ *
+ * @details "_build/app_fifo.o" gives "app_fifo.o"; "/x/libc_nano.a(lib_a-memcpy.o)" gives
+ *          "libc_nano.a", or "libc_nano.a(lib_a-memcpy.o)" with -m.
+ */
+static void module_name(const char * p_path, char * p_name)
+{
+    const char * p_member = strchr(p_path, '(');
+    const char * p_base   = p_path;
+    const char * p_slash;
+    size_t       length;
+
+    for (p_slash = p_path; (*p_slash != '\0') && (p_slash != p_member); p_slash++)
+    {
+        if ((*p_slash == '/') || (*p_slash == '\\'))
+        {
+            p_base = p_slash + 1;
+        }
+    }
+
+    length = ((p_member != NULL) && !m_members) ? (size_t)(p_member - p_base) : strlen(p_base);
+    if (length >= NAME_SIZE)
+    {
+        length = NAME_SIZE - 1;
+    }
+    memcpy(p_name, p_base, length);
+    p_name[length] = '\0';
+}
+
+
+static void module_add(const char * p_path, section_class_t cls, uint32_t size)
+{
+    char     name[NAME_SIZE];
+    uint32_t i;
+
+    module_name(p_path, name);
+    for (i = 0; i < m_module_count; i++)
+    {
+        if (strcmp(m_modules[i].name, name) == 0)
+        {
+            break;
+        }
+    }
+    if (i == m_module_count)
+    {
+        m_modules = realloc(m_modules, (m_module_count + 1) * sizeof(module_t));
+        if (m_modules == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+        memset(&m_modules[i], 0, sizeof(module_t));
+        strcpy(m_modules[i].name, name);
+        m_module_count++;
+    }
+    m_modules[i].size[cls] += size;
+}
+
+
+/**@brief Function for reading "0x<addr> 0x<size> <file>" after an input section name.
+ *
+ * @retval true  If the line holds them, with the file name stripped of the line end.
+ */
+static bool placement_parse(char * p_text, uint32_t * p_size, char ** pp_file)
+{
+    unsigned int addr;
+    unsigned int size;
+    int          used = 0;
+    char *       p_end;
+
+    if (sscanf(p_text, " 0x%x 0x%x %n", &addr, &size, &used) < 2 || (used == 0))
+    {
+        return false;
+    }
+    *p_size  = size;
+    *pp_file = p_text + used;
+    p_end    = *pp_file + strlen(*pp_file);
+    while ((p_end > *pp_file) && ((p_end[-1] == '\n') || (p_end[-1] == '\r') || (p_end[-1] == ' ')))
+    {
+        *--p_end = '\0';
+    }
+    return true;
+}
+
+
+static void map_read(FILE * p_in)
+{
+    char            line[LINE_SIZE];
+    char            name[NAME_SIZE];
+    section_class_t cls     = CLASS_NONE;
+    bool            started = false;
+    uint32_t        size;
+    char *          p_file;
+    int             used;
+
+    while (fgets(line, sizeof(line), p_in) != NULL)
+    {
+        if (!started)
+        {
+            started = (strncmp(line, "Linker script and memory map", 28) == 0);
+            continue;
+        }
+
+        if ((line[0] != ' ') && (line[0] != '\n') && (line[0] != '\r'))
+        {
+            // Output section, or LOAD and the like, which load nothing.
+            if (sscanf(line, "%127s", name) == 1)
+            {
+                cls = section_class(name);
+            }
+        }
+        else if ((cls != CLASS_NONE) && (line[0] == ' ') && (line[1] != ' ') &&
+                 (line[1] != '*') && (line[1] != '\n') && (line[1] != '\r'))
+        {
+            // Input section, its placement on the same line or, for long names, the next.
+            if (sscanf(line, " %127s%n", name, &used) != 1)
+            {
+                continue;
+            }
+            if (!placement_parse(line + used, &size, &p_file))
+            {
+                // Names such as KEEP (*(.init)) are patterns, not sections.
+                if ((strspn(line + used, " \r\n") != strlen(line + used)) ||
+                    (fgets(line, sizeof(line), p_in) == NULL) ||
+                    !placement_parse(line, &size, &p_file))
+                {
+                    continue;
+                }
+            }
+            if ((size != 0) && (*p_file != '\0'))
+            {
+                module_add(p_file, cls, size);
+            }
+        }
+    }
+}
+
+
+static uint32_t module_flash(module_t const * p_module)
+{
+    return p_module->size[CLASS_TEXT] + p_module->size[CLASS_DATA];
+}
+
+
+/**@brief Sorts by flash taken, largest first, then by name. */
+static int module_compare(const void * p_a, const void * p_b)
+{
+    module_t const * p_module_a = p_a;
+    module_t const * p_module_b = p_b;
+    uint32_t         flash_a    = module_flash(p_module_a);
+    uint32_t         flash_b    = module_flash(p_module_b);
+
+    if (flash_a != flash_b)
+    {
+        return (flash_a > flash_b) ? -1 : 1;
+    }
+    return strcmp(p_module_a->name, p_module_b->name);
+}
+
+
+static void row_print(const char * p_name, uint32_t const * p_size)
+{
+    printf("%-32s %7u %7u %7u %7u %7u\n", p_name,
+           p_size[CLASS_TEXT], p_size[CLASS_DATA], p_size[CLASS_BSS],
+           p_size[CLASS_TEXT] + p_size[CLASS_DATA], p_size[CLASS_DATA] + p_size[CLASS_BSS]);
+}
+
+
+int main(int argc, char ** argv)
+{
+    uint32_t total[4] = {0};
+    FILE *   p_in;
+    int      arg = 1;
+    uint32_t i;
+
+    if ((argc > arg) && (strcmp(argv[arg], "-m") == 0))
+    {
+        m_members = true;
+        arg++;
+    }
+    if (argc != arg + 1)
+    {
+        fprintf(stderr, "usage: %s [-m] app.map\n", argv[0]);
+        return 2;
+    }
+    p_in = fopen(argv[arg], "r");
+    if (p_in == NULL)
+    {
+        perror(argv[arg]);
+        return 1;
+    }
+    map_read(p_in);
+    fclose(p_in);
+
+    if (m_module_count == 0)
+    {
+        fprintf(stderr, "no memory map in %s\n", argv[arg]);
+        return 1;
+    }
+    qsort(m_modules, m_module_count, sizeof(module_t), module_compare);
+
+    printf("%-32s %7s %7s %7s %7s %7s\n", "module", "text", "data", "bss", "flash", "ram");
+    for (i = 0; i < m_module_count; i++)
+    {
+        row_print(m_modules[i].name, m_modules[i].size);
+        total[CLASS_TEXT] += m_modules[i].size[CLASS_TEXT];
+        total[CLASS_DATA] += m_modules[i].size[CLASS_DATA];
+        total[CLASS_BSS]  += m_modules[i].size[CLASS_BSS];
+    }
+    row_print("total", total);
+
+    free(m_modules);
+    return 0;
+}